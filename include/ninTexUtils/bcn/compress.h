@@ -0,0 +1,59 @@
+#ifndef NIN_TEX_UTILS_BCN_COMPRESS_H_
+#define NIN_TEX_UTILS_BCN_COMPRESS_H_
+
+#include <ninTexUtils/types.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum _BCnQuality
+{
+    // Endpoints from the bounding box of the block's colors (or the range
+    // of its values for single-channel blocks)
+    BCN_QUALITY_FAST   = 0,
+    // Endpoints along the principal axis of the block's colors (or both
+    // palette modes for single-channel blocks), refined once by least
+    // squares
+    BCN_QUALITY_NORMAL = 1,
+    // Same as normal, with further refinement and a local search of the
+    // endpoints
+    BCN_QUALITY_HIGH   = 2
+}
+BCnQuality;
+
+// Images are encoded from RGBA8, width * 4 bytes per row, to
+// ((width + 3) / 4) * ((height + 3) / 4) blocks stored row by row, which is
+// the layout of a GX2 surface of the format in GX2_TILE_MODE_LINEAR_SPECIAL
+// (e.g. the input of GX2TextureFromLinear2D). Blocks crossing the right or
+// bottom edge of the image are padded with copies of the edge texels.
+// BC1 encodes texels with alpha < 128 as transparent (punch-through alpha).
+// BC4 encodes the R component of the texels and BC5 the R and G components.
+// Signed values are biased by 128 (0 is -128, 255 is 127), as output by the
+// decoders (see decompress.h).
+// The output does not depend on the SIMD extensions of the host.
+
+void BCn_CompressBC1 (u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC2 (u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC3 (u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC4S(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC4U(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC5S(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC5U(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+
+// Same as above, with large images split into bands of block rows encoded
+// on the thread pool (see thread_pool.h). The output is identical.
+void BCn_CompressBC1Parallel (u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC2Parallel (u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC3Parallel (u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC4SParallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC4UParallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC5SParallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+void BCn_CompressBC5UParallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,20 @@ extern "C"
 {
 #endif
 
+typedef enum _BCnFormat
+{
+    BCN_FORMAT_BC1  = 0,
+    BCN_FORMAT_BC2  = 1,
+    BCN_FORMAT_BC3  = 2,
+    BCN_FORMAT_BC4U = 3,
+    BCN_FORMAT_BC4S = 4,
+    BCN_FORMAT_BC5U = 5,
+    BCN_FORMAT_BC5S = 6
+}
+BCnFormat;
+
+// Images are decoded to RGBA8, width * 4 bytes per row
+
 void BCn_DecompressBC1 (u32 width, u32 height, const u8* in_data, u8* out_data);
 void BCn_DecompressBC2 (u32 width, u32 height, const u8* in_data, u8* out_data);
 void BCn_DecompressBC3 (u32 width, u32 height, const u8* in_data, u8* out_data);
@@ -16,6 +30,16 @@ void BCn_DecompressBC4U(u32 width, u32 height, const u8* in_data, u8* out_data);
 void BCn_DecompressBC5S(u32 width, u32 height, const u8* in_data, u8* out_data);
 void BCn_DecompressBC5U(u32 width, u32 height, const u8* in_data, u8* out_data);
 
+// Same as above, with large images split into bands of block rows decoded
+// on the thread pool (see thread_pool.h). The output is identical.
+void BCn_DecompressBC1Parallel (u32 width, u32 height, const u8* in_data, u8* out_data);
+void BCn_DecompressBC2Parallel (u32 width, u32 height, const u8* in_data, u8* out_data);
+void BCn_DecompressBC3Parallel (u32 width, u32 height, const u8* in_data, u8* out_data);
+void BCn_DecompressBC4SParallel(u32 width, u32 height, const u8* in_data, u8* out_data);
+void BCn_DecompressBC4UParallel(u32 width, u32 height, const u8* in_data, u8* out_data);
+void BCn_DecompressBC5SParallel(u32 width, u32 height, const u8* in_data, u8* out_data);
+void BCn_DecompressBC5UParallel(u32 width, u32 height, const u8* in_data, u8* out_data);
+
 inline void BCn_DecompressBC4(u32 width, u32 height, const u8* in_data, u8* out_data, bool snorm)
 {
     if (snorm)
@@ -32,6 +56,28 @@ inline void BCn_DecompressBC5(u32 width, u32 height, const u8* in_data, u8* out_
         BCn_DecompressBC5U(width, height, in_data, out_data);
 }
 
+inline void BCn_DecompressBC4Parallel(u32 width, u32 height, const u8* in_data, u8* out_data, bool snorm)
+{
+    if (snorm)
+        BCn_DecompressBC4SParallel(width, height, in_data, out_data);
+    else
+        BCn_DecompressBC4UParallel(width, height, in_data, out_data);
+}
+
+inline void BCn_DecompressBC5Parallel(u32 width, u32 height, const u8* in_data, u8* out_data, bool snorm)
+{
+    if (snorm)
+        BCn_DecompressBC5SParallel(width, height, in_data, out_data);
+    else
+        BCn_DecompressBC5UParallel(width, height, in_data, out_data);
+}
+
+// Decodes the top-left width x height texels (height <= 4) of the
+// (width + 3) / 4 consecutive blocks at in_data, to RGBA8 rows out_pitch
+// bytes apart. Building block for decoders of image data stored in other
+// layouts (e.g. tiled GX2 surfaces), one row of blocks at a time.
+void BCn_DecompressBlockRow(BCnFormat format, u32 width, u32 height, const u8* in_data, u8* out_data, u32 out_pitch);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,49 @@
+#ifndef NIN_TEX_UTILS_CPU_FEATURES_H_
+#define NIN_TEX_UTILS_CPU_FEATURES_H_
+
+#include "types.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define CPU_FEATURES_ARCH_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+    #define CPU_FEATURES_ARCH_ARM 1
+#endif
+
+// Functions using instruction sets above the compilation baseline
+// (selected at runtime through CPUFeatures_Get) are marked with these
+#if defined(CPU_FEATURES_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define CPU_FEATURES_TARGET_SSSE3 __attribute__((target("ssse3")))
+    #define CPU_FEATURES_TARGET_SSE41 __attribute__((target("sse4.1")))
+    #define CPU_FEATURES_TARGET_AVX2  __attribute__((target("avx2")))
+#else
+    #define CPU_FEATURES_TARGET_SSSE3
+    #define CPU_FEATURES_TARGET_SSE41
+    #define CPU_FEATURES_TARGET_AVX2
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum _CPUFeature
+{
+    CPU_FEATURE_SSE2  = 1 << 0,
+    CPU_FEATURE_SSSE3 = 1 << 1,
+    CPU_FEATURE_SSE41 = 1 << 2,
+    CPU_FEATURE_AVX2  = 1 << 3,
+    CPU_FEATURE_NEON  = 1 << 4
+}
+CPUFeature;
+
+// Features supported by the host, limited to the mask set with
+// CPUFeatures_SetMask (e.g. 0 forces the portable code paths)
+u32 CPUFeatures_Get(void);
+
+void CPUFeatures_SetMask(u32 mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -115,67 +115,18 @@ inline void TexFormatUtils_GetComponentsFromPixel(TexFormatUtilsFormat format,
     }
 }
 
-inline void TexFormatUtils_ToRGBA8(u32 width, u32 height,
-                                   const u8* in_data,
-                                   u8* out_data,
-                                   TexFormatUtilsFormat format,
-                                   TexFormatUtilsComponent comp_r_sel,
-                                   TexFormatUtilsComponent comp_g_sel,
-                                   TexFormatUtilsComponent comp_b_sel,
-                                   TexFormatUtilsComponent comp_a_sel)
-{
-    u8 comp[] = {
-        0,   /* TEX_FORMAT_UTILS_COMPONENT_R */
-        0,   /* TEX_FORMAT_UTILS_COMPONENT_G */
-        0,   /* TEX_FORMAT_UTILS_COMPONENT_B */
-        255, /* TEX_FORMAT_UTILS_COMPONENT_A */
-        0,   /* TEX_FORMAT_UTILS_COMPONENT_0 */
-        255, /* TEX_FORMAT_UTILS_COMPONENT_1 */
-    };
-
-    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
-    if (bpp == 0)
-        return;
-
-    for (u32 y = 0; y < height; y++)
-    {
-        for (u32 x = 0; x < width; x++)
-        {
-            const u32 pixel_idx = y * width + x;
-            const u32 in_pos = pixel_idx * bpp;
-            const u32 out_pos = pixel_idx * 4;
-
-            /* Read pixel data in little endian */
-
-            switch (bpp)
-            {
-            case 1:
-                TexFormatUtils_GetComponentsFromPixel(format,
-                                                      in_data[in_pos],
-                                                      comp);
-                break;
-            case 2:
-                TexFormatUtils_GetComponentsFromPixel(format,
-                                                      (in_data[in_pos] |
-                                                       in_data[in_pos + 1] << 8),
-                                                      comp);
-                break;
-            case 4:
-                TexFormatUtils_GetComponentsFromPixel(format,
-                                                      (in_data[in_pos] |
-                                                       in_data[in_pos + 1] << 8 |
-                                                       in_data[in_pos + 2] << 16 |
-                                                       in_data[in_pos + 3] << 24),
-                                                      comp);
-            }
-
-            out_data[out_pos + 0] = comp[comp_r_sel];
-            out_data[out_pos + 1] = comp[comp_g_sel];
-            out_data[out_pos + 2] = comp[comp_b_sel];
-            out_data[out_pos + 3] = comp[comp_a_sel];
-        }
-    }
-}
+// Converts width * height pixels of the given format to RGBA8, with each
+// output component taken from the selected component of the pixel.
+// Uses SIMD kernels selected at runtime where available; results are
+// identical to converting each pixel with TexFormatUtils_GetComponentsFromPixel.
+void TexFormatUtils_ToRGBA8(u32 width, u32 height,
+                            const u8* in_data,
+                            u8* out_data,
+                            TexFormatUtilsFormat format,
+                            TexFormatUtilsComponent comp_r_sel,
+                            TexFormatUtilsComponent comp_g_sel,
+                            TexFormatUtilsComponent comp_b_sel,
+                            TexFormatUtilsComponent comp_a_sel);
 
 inline void TexFormatUtils_ToRGBA8_CompSelArr(u32 width, u32 height,
                                               const u8* in_data,
@@ -209,6 +160,18 @@ inline void TexFormatUtils_ToRGBA8_CompSelBits(u32 width, u32 height,
                            (TexFormatUtilsComponent)(comp_sel >>  0 & 0xFF));
 }
 
+// Converts width * height RGBA8 pixels to the given format, the reverse of
+// TexFormatUtils_ToRGBA8 with the identity component selection (L8 takes
+// R, LA4 and LA8 take R and G, RGBX8 stores 0xFF in X), so the output is a
+// linear image of the matching GX2 format (e.g. for GX2TextureFromLinear2D).
+// Components are rounded to the nearest value of the format or, if dither
+// is set, quantized with a 4x4 ordered dither pattern.
+void TexFormatUtils_FromRGBA8(u32 width, u32 height,
+                              const u8* in_data,
+                              u8* out_data,
+                              TexFormatUtilsFormat format,
+                              bool dither);
+
 inline void TexFormatUtils_RGB8ToRGBX8(u32 width, u32 height,
                                        const u8* in_data,
                                        u8* out_data)
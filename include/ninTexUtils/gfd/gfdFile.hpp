@@ -15,6 +15,8 @@ class GFDFile
 public:
     GFDFile()
         : mHeader() // Zero-initialize
+        , mBorrowedBegin(NULL)
+        , mBorrowedEnd(NULL)
     {
         mHeader.magic = 0x47667832u; // Gfx2
         mHeader.size = sizeof(GFDHeader);
@@ -46,10 +48,21 @@ public:
         return true;
     }
 
-    size_t load(const void* data);
+    // If borrowData is set, the image, mipmap and shader program data are
+    // not copied: their pointers reference the data in the given buffer,
+    // which must be kept alive (and unmodified) until the file is destroyed
+    // or loaded again. destroy() only frees the data it allocated, so the
+    // pointers can still be replaced with new[]-allocated data.
+    size_t load(const void* data, bool borrowData = false);
     std::vector<u8> saveGTX() const;
     void destroy();
 
+    bool isDataBorrowed(const void* ptr) const
+    {
+        return (uintptr_t)ptr >= (uintptr_t)mBorrowedBegin &&
+               (uintptr_t)ptr <  (uintptr_t)mBorrowedEnd;
+    }
+
 public:
     GFDHeader mHeader;
     std::vector<GX2Texture> mTextures;
@@ -57,4 +70,9 @@ public:
     std::vector<GX2PixelShader> mPixelShaders;
     std::vector<GX2GeometryShader> mGeometryShaders;
     //std::vector<GX2ComputeShader> mComputeShaders;
+
+private:
+    // Range of the buffer referenced by a borrowing load
+    const void* mBorrowedBegin;
+    const void* mBorrowedEnd;
 };
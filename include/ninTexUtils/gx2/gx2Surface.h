@@ -2,6 +2,7 @@
 #define NIN_TEX_UTILS_GX2_SURFACE_H_
 
 #include "gx2Enum.h"
+#include <ninTexUtils/mip_filter.h>
 #include <assert.h>
 
 typedef struct _GX2Surface
@@ -34,6 +35,10 @@ extern "C"
 
 void GX2CalcSurfaceSizeAndAlignment(GX2Surface* surf);
 
+// Copies one slice of one level of src to one slice of one level of dst,
+// which is expected to have the same dimensions (in which case elements
+// are copied one to one). Levels of different dimensions are resampled,
+// as with GX2ResampleSurface.
 void GX2CopySurface(
     const GX2Surface* src,
     u32               srcLevel,
@@ -43,6 +48,176 @@ void GX2CopySurface(
     u32               dstSlice
 );
 
+// Nearest-neighbor resampling of one slice of one level of src to one
+// slice of one level of dst, of any dimensions.
+void GX2ResampleSurface(
+    const GX2Surface* src,
+    u32               srcLevel,
+    u32               srcSlice,
+    GX2Surface*       dst,
+    u32               dstLevel,
+    u32               dstSlice
+);
+
+// Copies every slice (up to the depth of the smaller surface) of the first
+// numLevels levels of src to the same level and slice of dst.
+// Copies are split across levels, slices and macro tile rows, and run on
+// the texture thread pool (see thread_pool.h); the result is identical to
+// copying each level and slice in turn with GX2CopySurface.
+void GX2CopySurfaceLevels(
+    const GX2Surface* src,
+    GX2Surface*       dst,
+    u32               numLevels
+);
+
+// Copies every level and slice of src to dst, which describes the same
+// texture (dimensions, levels, format, AA mode) with another tile mode
+// and/or swizzle, and must have gone through GX2CalcSurfaceSizeAndAlignment
+// and have its image data allocated. Elements go straight from the src
+// tiling to the dst tiling, without a linear intermediate.
+void GX2RetileSurface(
+    const GX2Surface* src,
+    GX2Surface*       dst
+);
+
+// Same as GX2RetileSurface, for a dst that only differs from src by its
+// bank/pipe swizzle (bits 8-15 of swizzle). Macro tiled levels are moved
+// 256 bytes at a time, other levels as a whole.
+void GX2RebaseSurfaceSwizzle(
+    const GX2Surface* src,
+    GX2Surface*       dst
+);
+
+// Same as GX2CopySurface, for levels of identical dimensions, except that
+// a tiled src is read strictly front to back, at most 256 bytes at a time,
+// including the micro tiles split into pieces of 64 and 128 bpp macro
+// tiled surfaces (writes to dst are scattered instead), which suits src
+// image data mapped from slow storage.
+// Runs on the calling thread.
+void GX2CopySurfaceSequentialRead(
+    const GX2Surface* src,
+    u32               srcLevel,
+    u32               srcSlice,
+    GX2Surface*       dst,
+    u32               dstLevel,
+    u32               dstSlice
+);
+
+// Decodes one slice of one level of a BCn-compressed surface, in any tile
+// mode, to RGBA8 (see bcn/decompress.h), with max(width >> level, 1) * 4
+// bytes per row. Blocks are read straight from the image data of the
+// surface, one row of blocks at a time, without a linear copy of the level.
+// Runs on the texture thread pool (see thread_pool.h).
+void GX2DecompressSurface(
+    const GX2Surface* surf,
+    u32               level,
+    u32               slice,
+    u8*               outData
+);
+
+// Same as GX2DecompressSurface, for the width x height texels of the level
+// starting at (x, y), with width * 4 bytes per row. Only the micro tiles
+// and blocks overlapping the region are read, and the tiling plan of the
+// level is neither built nor cached, so that the cost depends on the size
+// of the region rather than that of the level.
+void GX2DecompressSurfaceRegion(
+    const GX2Surface* surf,
+    u32               level,
+    u32               slice,
+    u32               x,
+    u32               y,
+    u32               width,
+    u32               height,
+    u8*               outData
+);
+
+// Converts one slice of one level of a surface of format R8, RG4, RG8,
+// RGB565, RGB5A1, RGBA4, RGB10A2 or RGBA8, in any tile mode, to RGBA8 with
+// max(width >> level, 1) * 4 bytes per row, applying the given component
+// selectors (as in GX2Texture::compSel and TexFormatUtils_ToRGBA8_CompSelBits
+// in format_utils.h). Each row is converted as soon as it is read from the
+// image data of the surface, without a linear copy of the level.
+// Runs on the texture thread pool (see thread_pool.h).
+// Returns false, without writing anything, for other formats.
+bool GX2ConvertSurfaceToRGBA8(
+    const GX2Surface* surf,
+    u32               level,
+    u32               slice,
+    u32               compSel,
+    u8*               outData
+);
+
+// Generates levels 1 to numMips - 1 of every slice of a surface, in any
+// tile mode, from its level 0, which is converted to RGBA8 (as with
+// GX2ConvertSurfaceToRGBA8 or GX2DecompressSurface). Each level is
+// filtered from the RGBA8 texels of the previous one (see mip_utils.h), in
+// linear light for SRGB formats, converted back to the format of the
+// surface (BCn formats are encoded at BCN_QUALITY_NORMAL, see
+// bcn/compress.h) and tiled into mipPtr. Levels are filtered in bands of
+// rows: level 0 is decoded from the surface one band at a time and only
+// two levels from level 1 on are held at a time, as RGBA8.
+// Returns false, without writing anything, for 3D surfaces and for formats
+// not supported by GX2SurfaceFormatCanGenerateMips.
+bool GX2GenerateSurfaceMips(
+    GX2Surface*       surf,
+    TexMipUtilsFilter filter
+);
+
+// Whether GX2GenerateSurfaceMips supports the format: those of
+// GX2ConvertSurfaceToRGBA8 and the BCn formats.
+bool GX2SurfaceFormatCanGenerateMips(GX2SurfaceFormat format);
+
+typedef struct _GX2SurfaceByteRange
+{
+    u32 offset; // From imagePtr for level 0, from mipPtr for other levels
+    u32 size;
+}
+GX2SurfaceByteRange;
+
+// Computes the byte ranges of the image data of one slice of one level
+// holding the width x height texels starting at (x, y) (or the blocks
+// covering them, for compressed formats), e.g. to prefetch or read only
+// these from a file. Ranges are sorted by offset and coalesced: ranges
+// never overlap or touch. Up to maxRanges ranges are written to ranges
+// and the total number of ranges is returned.
+// Only single-sampled surfaces are supported.
+u32 GX2GetSurfaceRegionByteRanges(
+    const GX2Surface*    surf,
+    u32                  level,
+    u32                  slice,
+    u32                  x,
+    u32                  y,
+    u32                  width,
+    u32                  height,
+    GX2SurfaceByteRange* ranges,
+    u32                  maxRanges
+);
+
+// GX2CopySurface caches the address tables ("tiling plans") it builds for
+// each (surface layout, level, slice) in a bounded LRU cache shared by all
+// threads, so that copies of identically laid out surfaces skip the address
+// computation. Plans can be prebuilt and pinned (never evicted) up front.
+void GX2SetTilingPlanCacheSize(size_t maxSize); // In bytes, 0 disables caching
+
+void GX2PrebuildTilingPlan(
+    const GX2Surface* surf,
+    u32               level,
+    u32               slice,
+#ifdef __cplusplus
+    bool              pin = false
+#else
+    bool              pin
+#endif
+);
+
+void GX2ClearTilingPlanCache(
+#ifdef __cplusplus
+    bool unpin = false
+#else
+    bool unpin
+#endif
+);
+
 void GX2SurfaceVerifyForSerialization(const GX2Surface* surf);
 
 void LoadGX2Surface(
@@ -100,6 +100,33 @@ void GX2TextureFromLinear2D(
 #endif
 );
 
+// Same as GX2TextureFromLinear2D, with only level 0 supplied and levels 1
+// to numMips - 1 generated from it with the given filter (see
+// GX2GenerateSurfaceMips), straight into the tiled mip data of the texture.
+// Returns false, with texture zeroed and nothing allocated, for formats not
+// supported by GX2GenerateSurfaceMips (see GX2SurfaceFormatCanGenerateMips).
+bool GX2TextureFromLinear2DGenerateMips(
+    GX2Texture*       texture,
+    u32               width,
+    u32               height,
+    u32               numMips,
+    GX2SurfaceFormat  format,
+    u32               compSel,
+    const u8*         imagePtr,
+    size_t            imageSize,
+#ifdef __cplusplus
+    TexMipUtilsFilter filter   = TEX_MIP_UTILS_FILTER_BOX,
+    GX2TileMode       tileMode = GX2_TILE_MODE_DEFAULT,
+    u32               swizzle  = 0,
+    bool              gfd_v7   = true
+#else
+    TexMipUtilsFilter filter,
+    GX2TileMode       tileMode,
+    u32               swizzle,
+    bool              gfd_v7
+#endif
+);
+
 void GX2TextureFromDDS(
     GX2Texture* texture,
     const u8*   file,
@@ -196,6 +196,35 @@ typedef struct _ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT
 }
 ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT;
 
+typedef struct _ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT
+{
+    u32 size;
+    u64 addr;
+    u32 bitPosition;
+    u32 bpp;
+    u32 pitch;
+    u32 height;
+    u32 numSlices;
+    u32 numSamples;
+    AddrTileMode tileMode;
+    bool isDepth;
+    u32 tileBase;
+    u32 compBits;
+    u32 pipeSwizzle;
+    u32 bankSwizzle;
+}
+ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT;
+
+typedef struct _ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT
+{
+    u32 size;
+    u32 x;
+    u32 y;
+    u32 slice;
+    u32 sample;
+}
+ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT;
+
 ADDR_E_RETURNCODE AddrComputeSurfaceInfo(
     ADDR_COMPUTE_SURFACE_INFO_INPUT* pIn,
     ADDR_COMPUTE_SURFACE_INFO_OUTPUT* pOut
@@ -206,6 +235,59 @@ ADDR_E_RETURNCODE AddrComputeSurfaceAddrFromCoord(
     ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT* pOut
 );
 
+/* Inverse of AddrComputeSurfaceAddrFromCoord. Addresses in the padding  */
+/* of the surface resolve to coordinates beyond its dimensions.          */
+/* The addresses of 1D tiled surfaces do not depend on the sample (the   */
+/* forward computation ignores it), so multisampled 1D tiled surfaces    */
+/* do not round-trip: pOut->sample is 0 for every address.               */
+ADDR_E_RETURNCODE AddrComputeSurfaceCoordFromAddr(
+    const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+    ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+);
+
+/* Address computation specialized (at compile time) for the tile mode, */
+/* bpp and isDepth of a surface, selected with                          */
+/* AddrGetSurfaceAddrFromCoordFunc once for all coordinates of the      */
+/* surface. Unlike AddrComputeSurfaceAddrFromCoord, the input is not    */
+/* validated.                                                           */
+typedef u64 (*ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC)(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    u32* pBitPosition
+);
+
+ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC AddrGetSurfaceAddrFromCoordFunc(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn
+);
+
+/* Resolves the addresses of count coordinates (pX[i], pY[i]) of the    */
+/* surface described by pIn, whose x and y are ignored. pSlice and       */
+/* pSample may be NULL to use pIn->slice and pIn->sample for all of      */
+/* them, and pBitPosition may be NULL if it is not needed.               */
+/* Coordinates are not validated (unlike AddrComputeSurfaceAddrFromCoord) */
+/* and the addresses of out-of-bounds coordinates are undefined.         */
+ADDR_E_RETURNCODE AddrComputeSurfaceAddrFromCoordBatch(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    u32 count,
+    const u32* pX,
+    const u32* pY,
+    const u32* pSlice,
+    const u32* pSample,
+    u64* pAddr,
+    u32* pBitPosition
+);
+
+/* Computes the byte offsets of the 8x8 elements of a micro tile (row-major) */
+/* relative to the address of the element at the micro tile's origin, such  */
+/* that addr(x, y) == addr(x & ~7, y & ~7) + pOffsets[(y & 7) * 8 + (x & 7)]. */
+/* pIn->x, pIn->y and pIn->sample are ignored.                               */
+/* Returns ADDR_NOTSUPPORTED if the surface layout cannot be expressed this  */
+/* way (multisampled surfaces, elements that are not a power-of-two number   */
+/* of bytes in macro-tiled modes, ...).                                      */
+ADDR_E_RETURNCODE AddrComputeSurfaceMicroTileOffsets(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    u32* pOffsets
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -104,6 +104,15 @@ private:
         ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT* pOut
     );
 
+    static inline ADDR_E_RETURNCODE ComputeSurfaceCoordFromAddr(
+        const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+        ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+    );
+    friend ADDR_E_RETURNCODE AddrComputeSurfaceCoordFromAddr(
+        const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+        ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+    );
+
     static inline u32 ComputeSurfaceThickness(
         AddrTileMode tileMode
     );
@@ -138,7 +147,7 @@ private:
         u32* pBitPosition
     );
 
-    static inline u32 ComputePixelIndexWithinMicroTile(
+    static /* inline */ forceinline u32 ComputePixelIndexWithinMicroTile(
         u32 x,
         u32 y,
         u32 z,
@@ -147,6 +156,29 @@ private:
         AddrTileType microTileType
     );
 
+    static inline void ComputeSurfaceCoordFromAddrLinear(
+        u64 addr,
+        u32 bitPosition,
+        u32 bpp,
+        u32 pitch,
+        u32 height,
+        u32 numSlices,
+        u32* pX,
+        u32* pY,
+        u32* pSlice,
+        u32* pSample
+    );
+
+    static inline void ComputePixelCoordFromOffset(
+        u32 offset,
+        u32 bpp,
+        AddrTileMode tileMode,
+        AddrTileType microTileType,
+        u32* pX,
+        u32* pY,
+        u32* pSlice
+    );
+
     friend class R600AddrLib;
 };
 
@@ -305,7 +337,7 @@ private:
         ADDR_COMPUTE_SURFACE_INFO_OUTPUT* pOut
     );
 
-    static inline u64 ComputeSurfaceAddrFromCoordMicroTiled(
+    static /* inline */ forceinline u64 ComputeSurfaceAddrFromCoordMicroTiled(
         u32 x,
         u32 y,
         u32 slice,
@@ -347,11 +379,79 @@ private:
         u32* pBitPosition
     );
 
+    static u64 ComputeSurfaceAddrFromCoordGeneric(
+        const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+        u32* pBitPosition
+    );
+
+    template <AddrTileMode tileMode, u32 bpp, bool isDepthSampleOrder>
+    static u64 ComputeSurfaceAddrFromCoordSpecialized(
+        const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+        u32* pBitPosition
+    );
+
+    template <AddrTileMode tileMode>
+    static inline ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC GetSurfaceAddrFromCoordFunc(
+        u32 bpp,
+        bool isDepthSampleOrder
+    );
+
+    static inline ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC GetSurfaceAddrFromCoordFunc(
+        const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn
+    );
+    friend ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC AddrGetSurfaceAddrFromCoordFunc(
+        const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn
+    );
+
     static /* inline */ forceinline u64 ComputeSurfaceAddrFromCoord(
         const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
         ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT* pOut
     );
 
+    static inline void ComputeSurfaceCoordFromAddrMicroTiled(
+        u64 addr,
+        u32 bitPosition,
+        u32 bpp,
+        u32 pitch,
+        u32 height,
+        AddrTileMode tileMode,
+        bool isDepthSampleOrder,
+        u32 tileBase,
+        u32 compBits,
+        u32* pX,
+        u32* pY,
+        u32* pSlice
+    );
+
+    static inline void ComputeSurfaceCoordFromAddrMacroTiled(
+        u64 addr,
+        u32 bitPosition,
+        u32 bpp,
+        u32 pitch,
+        u32 height,
+        u32 numSamples,
+        AddrTileMode tileMode,
+        bool isDepthSampleOrder,
+        u32 tileBase,
+        u32 compBits,
+        u32 pipeSwizzle,
+        u32 bankSwizzle,
+        u32* pX,
+        u32* pY,
+        u32* pSlice,
+        u32* pSample
+    );
+
+    static inline void ComputeSurfaceCoordFromAddr(
+        const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+        ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+    );
+
+    static inline ADDR_E_RETURNCODE HwlComputeSurfaceCoordFromAddr(
+        const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+        ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+    );
+
     static /* inline */ forceinline ADDR_E_RETURNCODE HwlComputeSurfaceInfo(
         const ADDR_COMPUTE_SURFACE_INFO_INPUT* pIn,
         ADDR_COMPUTE_SURFACE_INFO_OUTPUT* pOut
@@ -362,6 +462,36 @@ private:
         ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT* pOut
     );
 
+    static inline ADDR_E_RETURNCODE ComputeSurfaceAddrFromCoordBatch(
+        const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+        u32 count,
+        const u32* pX,
+        const u32* pY,
+        const u32* pSlice,
+        const u32* pSample,
+        u64* pAddr,
+        u32* pBitPosition
+    );
+    friend ADDR_E_RETURNCODE AddrComputeSurfaceAddrFromCoordBatch(
+        const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+        u32 count,
+        const u32* pX,
+        const u32* pY,
+        const u32* pSlice,
+        const u32* pSample,
+        u64* pAddr,
+        u32* pBitPosition
+    );
+
+    static inline ADDR_E_RETURNCODE ComputeSurfaceMicroTileOffsets(
+        const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+        u32* pOffsets
+    );
+    friend ADDR_E_RETURNCODE AddrComputeSurfaceMicroTileOffsets(
+        const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+        u32* pOffsets
+    );
+
 public:
     static inline void ExtractBankPipeSwizzle(
         u32 base256b,
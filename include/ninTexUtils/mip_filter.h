@@ -0,0 +1,25 @@
+#ifndef NIN_TEX_UTILS_MIP_FILTER_H_
+#define NIN_TEX_UTILS_MIP_FILTER_H_
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum _TexMipUtilsFilter
+{
+    // Average of the source texels covered by each destination texel
+    // (2x2 texels when both dimensions are halved)
+    TEX_MIP_UTILS_FILTER_BOX    = 0,
+    // Windowed sinc (3 lobes, Kaiser window), sharper than box
+    TEX_MIP_UTILS_FILTER_KAISER = 1
+}
+TexMipUtilsFilter;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
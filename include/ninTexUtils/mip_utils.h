@@ -0,0 +1,52 @@
+#ifndef NIN_TEX_UTILS_MIP_UTILS_H_
+#define NIN_TEX_UTILS_MIP_UTILS_H_
+
+#include "mip_filter.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Mip levels are filtered from images of RGBA texels with 4 f32 components
+// in [0, 1], width * 4 components per row.
+
+// Converts num_pixels RGBA8 pixels to f32. If srgb is set, R, G and B are
+// decoded from sRGB to linear light (alpha is always linear).
+void TexMipUtils_RGBA8ToFloat(u32 num_pixels, const u8* in_data, f32* out_data, bool srgb);
+
+// Reverse of TexMipUtils_RGBA8ToFloat, rounding to the nearest value
+// (components outside [0, 1] are clamped)
+void TexMipUtils_FloatToRGBA8(u32 num_pixels, const f32* in_data, u8* out_data, bool srgb);
+
+// Resamples an image to dst_width x dst_height (at most the source
+// dimensions, e.g. those of the next mip level) with the given filter,
+// separably, clamping to the edges of the image. Uses SIMD kernels
+// selected at runtime where available and runs on the texture thread pool
+// (see thread_pool.h).
+void TexMipUtils_Downsample(u32 src_width, u32 src_height, const f32* in_data,
+                            u32 dst_width, u32 dst_height, f32* out_data,
+                            TexMipUtilsFilter filter);
+
+// Images can also be resampled in bands of rows, e.g. to produce a level
+// without holding all the rows of the previous one as f32.
+// Computes the rows [*src_row_begin, *src_row_end) of the source image
+// read to filter rows [dst_y, dst_y + dst_rows) of the resampled image.
+// The rows needed by successive bands never move backwards.
+void TexMipUtils_GetDownsampleSourceRows(u32 src_height, u32 dst_height, u32 dst_y, u32 dst_rows,
+                                         TexMipUtilsFilter filter, u32* src_row_begin, u32* src_row_end);
+
+// Same as TexMipUtils_Downsample, for rows [dst_y, dst_y + dst_rows) of the
+// resampled image only, written from the start of out_data. in_data holds
+// the source rows from row src_y on, including at least those given by
+// TexMipUtils_GetDownsampleSourceRows. The result is identical to that of
+// TexMipUtils_Downsample.
+void TexMipUtils_DownsampleRows(u32 src_width, u32 src_height, u32 src_y, const f32* in_data,
+                                u32 dst_width, u32 dst_height, u32 dst_y, u32 dst_rows, f32* out_data,
+                                TexMipUtilsFilter filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
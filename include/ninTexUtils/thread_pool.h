@@ -0,0 +1,39 @@
+#ifndef NIN_TEX_UTILS_THREAD_POOL_H_
+#define NIN_TEX_UTILS_THREAD_POOL_H_
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Task executed for each index in [0, count) by TexThreadPool_ParallelFor.
+// Tasks of a same call may run concurrently, in any order.
+typedef void (*TexThreadPoolTask)(void* userData, u32 index);
+
+// Caller-supplied replacement for the internal thread pool.
+// Must call task(userData, i) once for each i in [0, count) and only
+// return once all of them have completed.
+typedef void (*TexThreadPoolScheduler)(void* schedulerData, u32 count, TexThreadPoolTask task, void* userData);
+
+// Number of threads (including the calling thread) used by the internal
+// thread pool. 0 selects the number of hardware threads, 1 runs everything
+// serially on the calling thread. Defaults to 0.
+void TexThreadPool_SetNumThreads(u32 numThreads);
+
+u32 TexThreadPool_GetNumThreads(void);
+
+// Routes all parallel work to the given scheduler instead of the internal
+// thread pool; NULL restores the internal thread pool
+void TexThreadPool_SetScheduler(TexThreadPoolScheduler scheduler, void* schedulerData);
+
+// Runs task(userData, i) for each i in [0, count) and waits for completion.
+// Nested calls (from within a task) run serially.
+void TexThreadPool_ParallelFor(u32 count, TexThreadPoolTask task, void* userData);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
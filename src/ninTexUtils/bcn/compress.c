@@ -0,0 +1,1327 @@
+#include <ninTexUtils/bcn/compress.h>
+#include <ninTexUtils/cpu_features.h>
+#include <ninTexUtils/thread_pool.h>
+#include <assert.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define BCN_ENCODE_KERNELS_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define BCN_ENCODE_KERNELS_NEON 1
+    #include <arm_neon.h>
+#endif
+
+static inline s16 EXP5TO8R(u16 packedcol)
+{
+    return (packedcol >> 8 & 0xF8) | (packedcol >> 13 & 0x07);
+}
+
+static inline s16 EXP6TO8G(u16 packedcol)
+{
+    return (packedcol >> 3 & 0xFC) | (packedcol >>  9 & 0x03);
+}
+
+static inline s16 EXP5TO8B(u16 packedcol)
+{
+    return (packedcol << 3 & 0xF8) | (packedcol >>  2 & 0x07);
+}
+
+#define RCOMP 0
+#define GCOMP 1
+#define BCOMP 2
+#define ACOMP 3
+
+// Color blocks are encoded by searching for the pair of endpoints whose
+// palette (computed exactly as the decoder does) minimizes the sum of the
+// squared RGB distances of the texels to their nearest palette entry.
+// Candidate endpoints come from a fit of the block's colors (bounding box
+// or principal axis), least-squares refinement against the current
+// indices and, at the highest quality, a local search in RGB565 space.
+// Evaluating a candidate (finding the nearest palette entry of each texel)
+// is the hot spot and has SIMD implementations, which are exact, so the
+// output does not depend on the kernel used.
+// Single-channel blocks (BC3 alpha, BC4 and BC5) are encoded the same way,
+// from the range of the block's values. Signed values are handled biased
+// by 128, as the decoder outputs them.
+
+// Value standing in for the color of transparent BC1 texels and for the
+// transparent entry of 3-color palettes: its distance to any 8-bit color
+// exceeds the distance between any two 8-bit colors, so transparent texels
+// map to the transparent entry and opaque texels never do
+#define BCN_TRANSPARENT_TEXEL 1023
+
+typedef struct
+{
+    s16 r[16];
+    s16 g[16];
+    s16 b[16];
+} BCnColorTexels;
+
+typedef struct
+{
+    s16 r[4];
+    s16 g[4];
+    s16 b[4];
+} BCnColorPalette;
+
+// Finds the nearest palette entry of each texel (the lowest one on ties).
+// Returns the sum of the squared distances, with the 2-bit index of texel k
+// in bits 2k and 2k + 1 of *indices.
+typedef u32 (*BCnColorIndicesFunc)(const BCnColorTexels* texels, const BCnColorPalette* palette, u32* indices);
+
+static u32 color_indices_generic(const BCnColorTexels* texels, const BCnColorPalette* palette, u32* indices)
+{
+    u32 error = 0;
+    u32 bits = 0;
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        u32 best_dist = ~0u;
+        u32 best_index = 0;
+
+        for (u32 e = 0; e < 4; e++)
+        {
+            const s32 dr = texels->r[k] - palette->r[e];
+            const s32 dg = texels->g[k] - palette->g[e];
+            const s32 db = texels->b[k] - palette->b[e];
+            const u32 dist = (u32)(dr * dr + dg * dg + db * db);
+
+            if (dist < best_dist)
+            {
+                best_dist = dist;
+                best_index = e;
+            }
+        }
+
+        error += best_dist;
+        bits |= best_index << 2 * k;
+    }
+
+    *indices = bits;
+    return error;
+}
+
+// SIMD searches.
+// Components are stored in 16-bit lanes; the differences of two texels'
+// R and G components are interleaved (and B with 0) so that pairwise
+// multiply-adds give their squared distance in 32-bit lanes.
+
+#if defined(BCN_ENCODE_KERNELS_X86)
+
+static inline CPU_FEATURES_TARGET_SSE41 u32 hsum_epi32_sse41(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+    return (u32)_mm_cvtsi128_si32(v);
+}
+
+// Squared distances of 8 texels to a palette entry, as texels 0-3 and 4-7
+static inline CPU_FEATURES_TARGET_SSE41 void color_distances_sse41(__m128i dr, __m128i dg, __m128i db, __m128i dist[2])
+{
+    const __m128i rg_lo = _mm_unpacklo_epi16(dr, dg);
+    const __m128i rg_hi = _mm_unpackhi_epi16(dr, dg);
+    const __m128i b_lo = _mm_unpacklo_epi16(db, _mm_setzero_si128());
+    const __m128i b_hi = _mm_unpackhi_epi16(db, _mm_setzero_si128());
+
+    dist[0] = _mm_add_epi32(_mm_madd_epi16(rg_lo, rg_lo), _mm_madd_epi16(b_lo, b_lo));
+    dist[1] = _mm_add_epi32(_mm_madd_epi16(rg_hi, rg_hi), _mm_madd_epi16(b_hi, b_hi));
+}
+
+static CPU_FEATURES_TARGET_SSE41 u32 color_indices_sse41(const BCnColorTexels* texels, const BCnColorPalette* palette, u32* indices)
+{
+    const __m128i index_scale = _mm_setr_epi32(1, 4, 16, 64);
+
+    __m128i error = _mm_setzero_si128();
+    u32 bits = 0;
+
+    for (u32 h = 0; h < 2; h++)
+    {
+        const __m128i r = _mm_loadu_si128((const __m128i*)(texels->r + h * 8));
+        const __m128i g = _mm_loadu_si128((const __m128i*)(texels->g + h * 8));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(texels->b + h * 8));
+
+        __m128i best_dist[2], best_index[2], dist[2];
+
+        color_distances_sse41(_mm_sub_epi16(r, _mm_set1_epi16(palette->r[0])),
+                              _mm_sub_epi16(g, _mm_set1_epi16(palette->g[0])),
+                              _mm_sub_epi16(b, _mm_set1_epi16(palette->b[0])), best_dist);
+        best_index[0] = best_index[1] = _mm_setzero_si128();
+
+        for (u32 e = 1; e < 4; e++)
+        {
+            color_distances_sse41(_mm_sub_epi16(r, _mm_set1_epi16(palette->r[e])),
+                                  _mm_sub_epi16(g, _mm_set1_epi16(palette->g[e])),
+                                  _mm_sub_epi16(b, _mm_set1_epi16(palette->b[e])), dist);
+
+            for (u32 j = 0; j < 2; j++)
+            {
+                const __m128i closer = _mm_cmplt_epi32(dist[j], best_dist[j]);
+                best_dist[j] = _mm_min_epi32(best_dist[j], dist[j]);
+                best_index[j] = _mm_blendv_epi8(best_index[j], _mm_set1_epi32((int)e), closer);
+            }
+        }
+
+        for (u32 j = 0; j < 2; j++)
+        {
+            error = _mm_add_epi32(error, best_dist[j]);
+            bits |= hsum_epi32_sse41(_mm_mullo_epi32(best_index[j], index_scale)) << (h * 16 + j * 8);
+        }
+    }
+
+    *indices = bits;
+    return hsum_epi32_sse41(error);
+}
+
+// AVX2 version of the above, on all 16 texels at once. Within each 128-bit
+// lane, the low halves hold texels 0-3 and 8-11 and the high halves texels
+// 4-7 and 12-15, which the index shifts account for.
+
+static inline CPU_FEATURES_TARGET_AVX2 void color_distances_avx2(__m256i dr, __m256i dg, __m256i db, __m256i dist[2])
+{
+    const __m256i rg_lo = _mm256_unpacklo_epi16(dr, dg);
+    const __m256i rg_hi = _mm256_unpackhi_epi16(dr, dg);
+    const __m256i b_lo = _mm256_unpacklo_epi16(db, _mm256_setzero_si256());
+    const __m256i b_hi = _mm256_unpackhi_epi16(db, _mm256_setzero_si256());
+
+    dist[0] = _mm256_add_epi32(_mm256_madd_epi16(rg_lo, rg_lo), _mm256_madd_epi16(b_lo, b_lo));
+    dist[1] = _mm256_add_epi32(_mm256_madd_epi16(rg_hi, rg_hi), _mm256_madd_epi16(b_hi, b_hi));
+}
+
+static CPU_FEATURES_TARGET_AVX2 u32 color_indices_avx2(const BCnColorTexels* texels, const BCnColorPalette* palette, u32* indices)
+{
+    const __m256i r = _mm256_loadu_si256((const __m256i*)texels->r);
+    const __m256i g = _mm256_loadu_si256((const __m256i*)texels->g);
+    const __m256i b = _mm256_loadu_si256((const __m256i*)texels->b);
+
+    __m256i best_dist[2], best_index[2], dist[2];
+
+    color_distances_avx2(_mm256_sub_epi16(r, _mm256_set1_epi16(palette->r[0])),
+                         _mm256_sub_epi16(g, _mm256_set1_epi16(palette->g[0])),
+                         _mm256_sub_epi16(b, _mm256_set1_epi16(palette->b[0])), best_dist);
+    best_index[0] = best_index[1] = _mm256_setzero_si256();
+
+    for (u32 e = 1; e < 4; e++)
+    {
+        color_distances_avx2(_mm256_sub_epi16(r, _mm256_set1_epi16(palette->r[e])),
+                             _mm256_sub_epi16(g, _mm256_set1_epi16(palette->g[e])),
+                             _mm256_sub_epi16(b, _mm256_set1_epi16(palette->b[e])), dist);
+
+        for (u32 j = 0; j < 2; j++)
+        {
+            const __m256i closer = _mm256_cmpgt_epi32(best_dist[j], dist[j]);
+            best_dist[j] = _mm256_min_epi32(best_dist[j], dist[j]);
+            best_index[j] = _mm256_blendv_epi8(best_index[j], _mm256_set1_epi32((int)e), closer);
+        }
+    }
+
+    const __m256i bits = _mm256_or_si256(_mm256_sllv_epi32(best_index[0], _mm256_setr_epi32(0, 2,  4,  6, 16, 18, 20, 22)),
+                                         _mm256_sllv_epi32(best_index[1], _mm256_setr_epi32(8, 10, 12, 14, 24, 26, 28, 30)));
+    const __m256i error = _mm256_add_epi32(best_dist[0], best_dist[1]);
+
+    *indices = hsum_epi32_sse41(_mm_add_epi32(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1)));
+    return hsum_epi32_sse41(_mm_add_epi32(_mm256_castsi256_si128(error), _mm256_extracti128_si256(error, 1)));
+}
+
+#elif defined(BCN_ENCODE_KERNELS_NEON)
+
+static u32 color_indices_neon(const BCnColorTexels* texels, const BCnColorPalette* palette, u32* indices)
+{
+    const int32x4_t index_shifts = { 0, 2, 4, 6 };
+
+    uint32x4_t error = vdupq_n_u32(0);
+    u32 bits = 0;
+
+    for (u32 q = 0; q < 4; q++)
+    {
+        const int16x4_t r = vld1_s16(texels->r + q * 4);
+        const int16x4_t g = vld1_s16(texels->g + q * 4);
+        const int16x4_t b = vld1_s16(texels->b + q * 4);
+
+        uint32x4_t best_dist = vdupq_n_u32(0), best_index = vdupq_n_u32(0);
+
+        for (u32 e = 0; e < 4; e++)
+        {
+            const int16x4_t dr = vsub_s16(r, vdup_n_s16(palette->r[e]));
+            const int16x4_t dg = vsub_s16(g, vdup_n_s16(palette->g[e]));
+            const int16x4_t db = vsub_s16(b, vdup_n_s16(palette->b[e]));
+            const uint32x4_t dist = vreinterpretq_u32_s32(vmlal_s16(vmlal_s16(vmull_s16(dr, dr), dg, dg), db, db));
+
+            if (e == 0)
+            {
+                best_dist = dist;
+                continue;
+            }
+
+            const uint32x4_t closer = vcltq_u32(dist, best_dist);
+            best_dist = vminq_u32(best_dist, dist);
+            best_index = vbslq_u32(closer, vdupq_n_u32(e), best_index);
+        }
+
+        error = vaddq_u32(error, best_dist);
+        bits |= vaddvq_u32(vshlq_u32(best_index, index_shifts)) << (q * 8);
+    }
+
+    *indices = bits;
+    return vaddvq_u32(error);
+}
+
+#endif
+
+static BCnColorIndicesFunc select_color_indices(void)
+{
+    const u32 features = CPUFeatures_Get();
+
+#if defined(BCN_ENCODE_KERNELS_X86)
+    if (features & CPU_FEATURE_AVX2)
+        return color_indices_avx2;
+
+    if (features & CPU_FEATURE_SSE41)
+        return color_indices_sse41;
+#elif defined(BCN_ENCODE_KERNELS_NEON)
+    if (features & CPU_FEATURE_NEON)
+        return color_indices_neon;
+#endif
+
+    (void)features;
+    return color_indices_generic;
+}
+
+// Same as BCnColorIndicesFunc, for single-channel (BC3 alpha, BC4 and BC5)
+// blocks: finds the nearest palette entry of each value (the lowest one on
+// ties). Returns the sum of the squared distances, with the 3-bit code of
+// value k in bits 3k to 3k + 2 of *codes.
+typedef u32 (*BCnChannelCodesFunc)(const u8 values[16], const u8 palette[8], u64* codes);
+
+static u32 channel_codes_generic(const u8 values[16], const u8 palette[8], u64* codes)
+{
+    u32 error = 0;
+    u64 bits = 0;
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        u32 best_dist = ~0u;
+        u32 best_code = 0;
+
+        for (u32 code = 0; code < 8; code++)
+        {
+            const s32 d = values[k] - palette[code];
+            const u32 dist = (u32)(d * d);
+
+            if (dist < best_dist)
+            {
+                best_dist = dist;
+                best_code = code;
+            }
+        }
+
+        error += best_dist;
+        bits |= (u64)best_code << 3 * k;
+    }
+
+    *codes = bits;
+    return error;
+}
+
+// The 16 values of a block fit in a single register, with their distances
+// to a palette entry computed as absolute differences of 8-bit lanes.
+// Codes are combined by pairs (6 bits) and then by fours (12 bits) before
+// being moved out of the register.
+
+#if defined(BCN_ENCODE_KERNELS_X86)
+
+static CPU_FEATURES_TARGET_SSE41 u32 channel_codes_sse41(const u8 values[16], const u8 palette[8], u64* codes)
+{
+    const __m128i v = _mm_loadu_si128((const __m128i*)values);
+    const __m128i all_ones = _mm_set1_epi8(-1);
+
+    __m128i p = _mm_set1_epi8((char)palette[0]);
+    __m128i best_dist = _mm_or_si128(_mm_subs_epu8(v, p), _mm_subs_epu8(p, v));
+    __m128i best_code = _mm_setzero_si128();
+
+    for (u32 code = 1; code < 8; code++)
+    {
+        p = _mm_set1_epi8((char)palette[code]);
+
+        const __m128i dist = _mm_or_si128(_mm_subs_epu8(v, p), _mm_subs_epu8(p, v));
+        const __m128i closer = _mm_xor_si128(_mm_cmpeq_epi8(_mm_max_epu8(dist, best_dist), dist), all_ones);
+
+        best_dist = _mm_min_epu8(best_dist, dist);
+        best_code = _mm_blendv_epi8(best_code, _mm_set1_epi8((char)code), closer);
+    }
+
+    const __m128i pairs = _mm_maddubs_epi16(best_code, _mm_set1_epi16(0x0801));
+    const __m128i fours = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00400001));
+
+    *codes = (u64)(u32)_mm_cvtsi128_si32(fours)
+           | (u64)(u32)_mm_extract_epi32(fours, 1) << 12
+           | (u64)(u32)_mm_extract_epi32(fours, 2) << 24
+           | (u64)(u32)_mm_extract_epi32(fours, 3) << 36;
+
+    const __m128i dist_lo = _mm_unpacklo_epi8(best_dist, _mm_setzero_si128());
+    const __m128i dist_hi = _mm_unpackhi_epi8(best_dist, _mm_setzero_si128());
+
+    return hsum_epi32_sse41(_mm_add_epi32(_mm_madd_epi16(dist_lo, dist_lo), _mm_madd_epi16(dist_hi, dist_hi)));
+}
+
+#elif defined(BCN_ENCODE_KERNELS_NEON)
+
+static u32 channel_codes_neon(const u8 values[16], const u8 palette[8], u64* codes)
+{
+    const uint8x16_t v = vld1q_u8(values);
+
+    uint8x16_t best_dist = vabdq_u8(v, vdupq_n_u8(palette[0]));
+    uint8x16_t best_code = vdupq_n_u8(0);
+
+    for (u32 code = 1; code < 8; code++)
+    {
+        const uint8x16_t dist = vabdq_u8(v, vdupq_n_u8(palette[code]));
+        const uint8x16_t closer = vcltq_u8(dist, best_dist);
+
+        best_dist = vminq_u8(best_dist, dist);
+        best_code = vbslq_u8(closer, vdupq_n_u8((u8)code), best_code);
+    }
+
+    const uint16x8_t codes16 = vreinterpretq_u16_u8(best_code);
+    const uint32x4_t pairs = vreinterpretq_u32_u16(vaddq_u16(vandq_u16(codes16, vdupq_n_u16(0xFF)),
+                                                             vshlq_n_u16(vshrq_n_u16(codes16, 8), 3)));
+    const uint32x4_t fours = vaddq_u32(vandq_u32(pairs, vdupq_n_u32(0xFFFF)),
+                                       vshlq_n_u32(vshrq_n_u32(pairs, 16), 6));
+
+    *codes = (u64)vgetq_lane_u32(fours, 0)
+           | (u64)vgetq_lane_u32(fours, 1) << 12
+           | (u64)vgetq_lane_u32(fours, 2) << 24
+           | (u64)vgetq_lane_u32(fours, 3) << 36;
+
+    const uint16x8_t squares_lo = vmull_u8(vget_low_u8(best_dist), vget_low_u8(best_dist));
+    const uint16x8_t squares_hi = vmull_u8(vget_high_u8(best_dist), vget_high_u8(best_dist));
+
+    return vaddvq_u32(vaddq_u32(vpaddlq_u16(squares_lo), vpaddlq_u16(squares_hi)));
+}
+
+#endif
+
+static BCnChannelCodesFunc select_channel_codes(void)
+{
+    const u32 features = CPUFeatures_Get();
+
+#if defined(BCN_ENCODE_KERNELS_X86)
+    if (features & CPU_FEATURE_SSE41)
+        return channel_codes_sse41;
+#elif defined(BCN_ENCODE_KERNELS_NEON)
+    if (features & CPU_FEATURE_NEON)
+        return channel_codes_neon;
+#endif
+
+    (void)features;
+    return channel_codes_generic;
+}
+
+typedef struct _BCnEncoder BCnEncoder;
+
+typedef void (*BCnEncodeBlockFunc)(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data);
+
+struct _BCnEncoder
+{
+    u32 block_size;
+    BCnEncodeBlockFunc encode_block;
+    BCnQuality quality;
+    BCnColorIndicesFunc color_indices;
+    BCnChannelCodesFunc channel_codes;
+};
+
+typedef struct
+{
+    const BCnEncoder* encoder;
+    BCnColorTexels texels;
+    bool is_dxt1;
+    bool has_transparent;
+
+    // Best endpoints found so far
+    u16 color0;
+    u16 color1;
+    u32 indices;
+    u32 error;
+} BCnColorSearch;
+
+static inline bool is_transparent_texel(const BCnColorTexels* texels, u32 k)
+{
+    return texels->r[k] == BCN_TRANSPARENT_TEXEL;
+}
+
+static inline u16 quantize_565(const f32 rgb[3])
+{
+    s32 r = (s32)(rgb[RCOMP] * 31.0f / 255.0f + 0.5f);
+    s32 g = (s32)(rgb[GCOMP] * 63.0f / 255.0f + 0.5f);
+    s32 b = (s32)(rgb[BCOMP] * 31.0f / 255.0f + 0.5f);
+
+    r = r < 0 ? 0 : r > 31 ? 31 : r;
+    g = g < 0 ? 0 : g > 63 ? 63 : g;
+    b = b < 0 ? 0 : b > 31 ? 31 : b;
+
+    return (u16)(r << 11 | g << 5 | b);
+}
+
+// Same palette as dxt135_decode_imageblock in decompress.c, with the
+// transparent entry of BC1 3-color blocks as BCN_TRANSPARENT_TEXEL
+static void build_color_palette(u16 color0, u16 color1, bool is_dxt1, BCnColorPalette* palette)
+{
+    const s16 r0 = EXP5TO8R(color0), g0 = EXP6TO8G(color0), b0 = EXP5TO8B(color0);
+    const s16 r1 = EXP5TO8R(color1), g1 = EXP6TO8G(color1), b1 = EXP5TO8B(color1);
+
+    palette->r[0] = r0; palette->g[0] = g0; palette->b[0] = b0;
+    palette->r[1] = r1; palette->g[1] = g1; palette->b[1] = b1;
+
+    if (color0 > color1)
+    {
+        palette->r[2] = (r0 * 2 + r1) / 3;
+        palette->g[2] = (g0 * 2 + g1) / 3;
+        palette->b[2] = (b0 * 2 + b1) / 3;
+    }
+    else
+    {
+        palette->r[2] = (r0 + r1) / 2;
+        palette->g[2] = (g0 + g1) / 2;
+        palette->b[2] = (b0 + b1) / 2;
+    }
+
+    if (!is_dxt1 || color0 > color1)
+    {
+        palette->r[3] = (r0 + r1 * 2) / 3;
+        palette->g[3] = (g0 + g1 * 2) / 3;
+        palette->b[3] = (b0 + b1 * 2) / 3;
+    }
+    else
+    {
+        palette->r[3] = BCN_TRANSPARENT_TEXEL;
+        palette->g[3] = BCN_TRANSPARENT_TEXEL;
+        palette->b[3] = BCN_TRANSPARENT_TEXEL;
+    }
+}
+
+// Evaluates the endpoints in the given order and keeps them if they are
+// better than the best so far
+static void try_color_endpoints(BCnColorSearch* search, u16 color0, u16 color1)
+{
+    // Blocks with transparent texels must be in 3-color mode
+    if (search->has_transparent && color0 > color1)
+        return;
+
+    BCnColorPalette palette;
+    build_color_palette(color0, color1, search->is_dxt1, &palette);
+
+    u32 indices;
+    const u32 error = search->encoder->color_indices(&search->texels, &palette, &indices);
+
+    if (error < search->error)
+    {
+        search->color0 = color0;
+        search->color1 = color1;
+        search->indices = indices;
+        search->error = error;
+    }
+}
+
+// Evaluates a pair of endpoints in 4-color mode and, for BC1 blocks, in
+// 3-color mode if try_3color is set (3-color mode only for BC1 blocks with
+// transparent texels)
+static void try_color_pair(BCnColorSearch* search, u16 color_a, u16 color_b, bool try_3color)
+{
+    const u16 color_max = color_a > color_b ? color_a : color_b;
+    const u16 color_min = color_a > color_b ? color_b : color_a;
+
+    if (!search->has_transparent)
+        try_color_endpoints(search, color_max, color_min);
+
+    if (search->is_dxt1 && (try_3color || search->has_transparent))
+        try_color_endpoints(search, color_min, color_max);
+}
+
+// Endpoints at the corners of the bounding box of the colors, inset by
+// 1/16 of its size, along the diagonal matching the signs of the colors'
+// covariance
+static void fit_bounding_box(const BCnColorSearch* search, f32 color_a[3], f32 color_b[3])
+{
+    const s16* comps[3] = { search->texels.r, search->texels.g, search->texels.b };
+
+    s32 min[3] = { 255, 255, 255 }, max[3] = { 0, 0, 0 }, sum[3] = { 0, 0, 0 };
+    u32 count = 0;
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        if (is_transparent_texel(&search->texels, k))
+            continue;
+
+        for (u32 c = 0; c < 3; c++)
+        {
+            const s32 v = comps[c][k];
+            min[c] = v < min[c] ? v : min[c];
+            max[c] = v > max[c] ? v : max[c];
+            sum[c] += v;
+        }
+        count++;
+    }
+
+    // Covariances of R and B with G
+    s32 cov_rg = 0, cov_bg = 0;
+    for (u32 k = 0; k < 16; k++)
+    {
+        if (is_transparent_texel(&search->texels, k))
+            continue;
+
+        const s32 dg = comps[GCOMP][k] * (s32)count - sum[GCOMP];
+        cov_rg += (comps[RCOMP][k] * (s32)count - sum[RCOMP]) * dg;
+        cov_bg += (comps[BCOMP][k] * (s32)count - sum[BCOMP]) * dg;
+    }
+
+    for (u32 c = 0; c < 3; c++)
+    {
+        const f32 inset = (f32)(max[c] - min[c]) / 16.0f;
+        color_a[c] = (f32)max[c] - inset;
+        color_b[c] = (f32)min[c] + inset;
+    }
+
+    if (cov_rg < 0)
+    {
+        const f32 t = color_a[RCOMP];
+        color_a[RCOMP] = color_b[RCOMP];
+        color_b[RCOMP] = t;
+    }
+
+    if (cov_bg < 0)
+    {
+        const f32 t = color_a[BCOMP];
+        color_a[BCOMP] = color_b[BCOMP];
+        color_b[BCOMP] = t;
+    }
+}
+
+// Endpoints at the extremes of the projections of the colors on their
+// principal axis, found by power iteration on their covariance matrix
+static void fit_principal_axis(const BCnColorSearch* search, f32 color_a[3], f32 color_b[3])
+{
+    const s16* comps[3] = { search->texels.r, search->texels.g, search->texels.b };
+
+    f32 mean[3] = { 0.0f, 0.0f, 0.0f };
+    u32 count = 0;
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        if (is_transparent_texel(&search->texels, k))
+            continue;
+
+        for (u32 c = 0; c < 3; c++)
+            mean[c] += comps[c][k];
+        count++;
+    }
+
+    for (u32 c = 0; c < 3; c++)
+        mean[c] /= (f32)count;
+
+    f32 cov[3][3] = { { 0.0f } };
+    for (u32 k = 0; k < 16; k++)
+    {
+        if (is_transparent_texel(&search->texels, k))
+            continue;
+
+        for (u32 i = 0; i < 3; i++)
+            for (u32 j = i; j < 3; j++)
+                cov[i][j] += (comps[i][k] - mean[i]) * (comps[j][k] - mean[j]);
+    }
+    cov[1][0] = cov[0][1];
+    cov[2][0] = cov[0][2];
+    cov[2][1] = cov[1][2];
+
+    // Start from the column of the component with the largest variance,
+    // which is not orthogonal to the principal axis unless all are 0
+    u32 start = 0;
+    for (u32 c = 1; c < 3; c++)
+        if (cov[c][c] > cov[start][start])
+            start = c;
+
+    f32 axis[3] = { cov[0][start], cov[1][start], cov[2][start] };
+
+    for (u32 iter = 0; iter < 8; iter++)
+    {
+        f32 next[3];
+        for (u32 i = 0; i < 3; i++)
+            next[i] = cov[i][0] * axis[0] + cov[i][1] * axis[1] + cov[i][2] * axis[2];
+
+        f32 norm = 0.0f;
+        for (u32 i = 0; i < 3; i++)
+        {
+            const f32 v = next[i] < 0.0f ? -next[i] : next[i];
+            norm = v > norm ? v : norm;
+        }
+
+        if (norm == 0.0f)
+            break;
+
+        for (u32 i = 0; i < 3; i++)
+            axis[i] = next[i] / norm;
+    }
+
+    const f32 axis_len2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    if (axis_len2 == 0.0f)
+    {
+        // Single color
+        memcpy(color_a, mean, sizeof(mean));
+        memcpy(color_b, mean, sizeof(mean));
+        return;
+    }
+
+    f32 t_min = 0.0f, t_max = 0.0f;
+    for (u32 k = 0; k < 16; k++)
+    {
+        if (is_transparent_texel(&search->texels, k))
+            continue;
+
+        const f32 t = (comps[0][k] - mean[0]) * axis[0] + (comps[1][k] - mean[1]) * axis[1] + (comps[2][k] - mean[2]) * axis[2];
+        t_min = t < t_min ? t : t_min;
+        t_max = t > t_max ? t : t_max;
+    }
+
+    for (u32 c = 0; c < 3; c++)
+    {
+        color_a[c] = mean[c] + axis[c] * t_max / axis_len2;
+        color_b[c] = mean[c] + axis[c] * t_min / axis_len2;
+    }
+}
+
+// Solves for the endpoints that minimize the squared error of the texels
+// given the current best indices. Returns false if the system is singular
+// (e.g. all texels use the same index).
+static bool refine_least_squares(const BCnColorSearch* search, f32 color0[3], f32 color1[3])
+{
+    // Weight of color0 in each palette entry
+    static const f32 weights_4color[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    static const f32 weights_3color[4] = { 1.0f, 0.0f, 1.0f / 2.0f, 0.0f };
+
+    const bool is_3color = search->color0 <= search->color1;
+    const f32* weights = is_3color ? weights_3color : weights_4color;
+    const s16* comps[3] = { search->texels.r, search->texels.g, search->texels.b };
+
+    f32 aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    f32 ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        const u32 index = search->indices >> 2 * k & 3;
+        if (is_transparent_texel(&search->texels, k) || (is_3color && index == 3))
+            continue;
+
+        const f32 w0 = weights[index];
+        const f32 w1 = 1.0f - w0;
+
+        aa += w0 * w0;
+        bb += w1 * w1;
+        ab += w0 * w1;
+
+        for (u32 c = 0; c < 3; c++)
+        {
+            ax[c] += w0 * comps[c][k];
+            bx[c] += w1 * comps[c][k];
+        }
+    }
+
+    const f32 det = aa * bb - ab * ab;
+    if (det > -1e-4f && det < 1e-4f)
+        return false;
+
+    for (u32 c = 0; c < 3; c++)
+    {
+        color0[c] = (bb * ax[c] - ab * bx[c]) / det;
+        color1[c] = (aa * bx[c] - ab * ax[c]) / det;
+    }
+
+    return true;
+}
+
+// Tries moving each component of each endpoint by one step until no move
+// improves the error (or the iteration limit is reached)
+static void search_color_neighbors(BCnColorSearch* search)
+{
+    static const u16 steps[3] = { 1 << 11, 1 << 5, 1 };
+    static const u16 masks[3] = { 0xF800, 0x07E0, 0x001F };
+
+    for (u32 iter = 0; iter < 4; iter++)
+    {
+        const u16 color0 = search->color0;
+        const u16 color1 = search->color1;
+
+        for (u32 c = 0; c < 3; c++)
+        {
+            const u16 field0 = color0 & masks[c], field1 = color1 & masks[c];
+
+            if (field0 != masks[c]) try_color_endpoints(search, color0 + steps[c], color1);
+            if (field0 != 0)        try_color_endpoints(search, color0 - steps[c], color1);
+            if (field1 != masks[c]) try_color_endpoints(search, color0, color1 + steps[c]);
+            if (field1 != 0)        try_color_endpoints(search, color0, color1 - steps[c]);
+        }
+
+        if (search->color0 == color0 && search->color1 == color1)
+            break;
+    }
+}
+
+static void encode_color_block(const BCnEncoder* encoder, const u8 texels[16][4], bool is_dxt1, u8* out_data)
+{
+    BCnColorSearch search;
+    search.encoder = encoder;
+    search.is_dxt1 = is_dxt1;
+    search.has_transparent = false;
+    search.color0 = 0;
+    search.color1 = 0;
+    search.indices = 0xFFFFFFFF;
+    search.error = ~0u;
+
+    u32 num_opaque = 0;
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        if (is_dxt1 && texels[k][ACOMP] < 128)
+        {
+            search.texels.r[k] = BCN_TRANSPARENT_TEXEL;
+            search.texels.g[k] = BCN_TRANSPARENT_TEXEL;
+            search.texels.b[k] = BCN_TRANSPARENT_TEXEL;
+            search.has_transparent = true;
+        }
+        else
+        {
+            search.texels.r[k] = texels[k][RCOMP];
+            search.texels.g[k] = texels[k][GCOMP];
+            search.texels.b[k] = texels[k][BCOMP];
+            num_opaque++;
+        }
+    }
+
+    // Fully transparent blocks keep the initial 3-color block with all
+    // texels on the transparent entry
+    if (num_opaque != 0)
+    {
+        const BCnQuality quality = encoder->quality;
+        f32 color_a[3], color_b[3];
+
+        if (quality == BCN_QUALITY_FAST)
+            fit_bounding_box(&search, color_a, color_b);
+        else
+            fit_principal_axis(&search, color_a, color_b);
+
+        try_color_pair(&search, quantize_565(color_a), quantize_565(color_b), quality != BCN_QUALITY_FAST);
+
+        if (quality != BCN_QUALITY_FAST)
+        {
+            const u32 num_refinements = quality == BCN_QUALITY_HIGH ? 3 : 1;
+
+            for (u32 i = 0; i < num_refinements && search.error != 0; i++)
+            {
+                const u32 error = search.error;
+
+                if (!refine_least_squares(&search, color_a, color_b))
+                    break;
+
+                try_color_pair(&search, quantize_565(color_a), quantize_565(color_b), true);
+
+                if (search.error == error)
+                    break;
+            }
+
+            if (quality == BCN_QUALITY_HIGH && search.error != 0)
+                search_color_neighbors(&search);
+        }
+    }
+
+    out_data[0] = search.color0 & 0xFF;
+    out_data[1] = search.color0 >> 8;
+    out_data[2] = search.color1 & 0xFF;
+    out_data[3] = search.color1 >> 8;
+    out_data[4] = search.indices & 0xFF;
+    out_data[5] = search.indices >> 8 & 0xFF;
+    out_data[6] = search.indices >> 16 & 0xFF;
+    out_data[7] = search.indices >> 24;
+}
+
+// Explicit 4-bit alpha, rounded to the nearest value
+static void encode_alpha_block_dxt3(const u8 texels[16][4], u8* out_data)
+{
+    memset(out_data, 0, 8);
+
+    for (u32 k = 0; k < 16; k++)
+        out_data[k / 2] |= ((texels[k][ACOMP] + 8) / 17) << 4 * (k & 1);
+}
+
+typedef struct
+{
+    const BCnEncoder* encoder;
+    u8 values[16];
+    bool is_signed;
+
+    // Best endpoints found so far
+    u8 value0;
+    u8 value1;
+    u64 codes;
+    u32 error;
+} BCnChannelSearch;
+
+// Same palette as dxt5_decode_alphablock and dxt5_decode_alphablock_signed
+// in decompress.c. Signed endpoints and entries are biased by 128, as the
+// values are, which keeps the order of the endpoints (and thus the mode).
+static void build_channel_palette(u8 value0, u8 value1, bool is_signed, u8 palette[8])
+{
+    palette[0] = value0;
+    palette[1] = value1;
+
+    if (is_signed)
+    {
+        const s32 v0 = value0 - 128;
+        const s32 v1 = value1 - 128;
+
+        if (value0 > value1)
+        {
+            for (s32 code = 2; code < 8; code++)
+                palette[code] = (v0 * (8 - code) + v1 * (code - 1)) / 7 + 128;
+        }
+        else
+        {
+            for (s32 code = 2; code < 6; code++)
+                palette[code] = (v0 * (6 - code) + v1 * (code - 1)) / 5 + 128;
+        }
+    }
+    else
+    {
+        if (value0 > value1)
+        {
+            for (u32 code = 2; code < 8; code++)
+                palette[code] = (value0 * (8 - code) + value1 * (code - 1)) / 7;
+        }
+        else
+        {
+            for (u32 code = 2; code < 6; code++)
+                palette[code] = (value0 * (6 - code) + value1 * (code - 1)) / 5;
+        }
+    }
+
+    if (value0 <= value1)
+    {
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// Evaluates the endpoints in the given order and keeps them if they are
+// better than the best so far
+static void try_channel_endpoints(BCnChannelSearch* search, u8 value0, u8 value1)
+{
+    u8 palette[8];
+    build_channel_palette(value0, value1, search->is_signed, palette);
+
+    u64 codes;
+    const u32 error = search->encoder->channel_codes(search->values, palette, &codes);
+
+    if (error < search->error)
+    {
+        search->value0 = value0;
+        search->value1 = value1;
+        search->codes = codes;
+        search->error = error;
+    }
+}
+
+static inline u8 clamp_channel_value(s32 value)
+{
+    return value < 0 ? 0 : value > 255 ? 255 : (u8)value;
+}
+
+// Solves for the endpoints that minimize the squared error of the values
+// given the current best codes. Returns false if the system is singular.
+static bool refine_channel_least_squares(const BCnChannelSearch* search, f32* value0, f32* value1)
+{
+    const bool is_6value = search->value0 <= search->value1;
+
+    f32 aa = 0.0f, bb = 0.0f, ab = 0.0f, ax = 0.0f, bx = 0.0f;
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        const u32 code = search->codes >> 3 * k & 7;
+
+        // Weight of value0 in the palette entry
+        f32 w0;
+        if (code < 2)
+            w0 = code == 0 ? 1.0f : 0.0f;
+        else if (!is_6value)
+            w0 = (f32)(8 - code) / 7.0f;
+        else if (code < 6)
+            w0 = (f32)(6 - code) / 5.0f;
+        else
+            continue;   // Explicit 0 or 255
+
+        const f32 w1 = 1.0f - w0;
+
+        aa += w0 * w0;
+        bb += w1 * w1;
+        ab += w0 * w1;
+        ax += w0 * search->values[k];
+        bx += w1 * search->values[k];
+    }
+
+    const f32 det = aa * bb - ab * ab;
+    if (det > -1e-4f && det < 1e-4f)
+        return false;
+
+    *value0 = (bb * ax - ab * bx) / det;
+    *value1 = (aa * bx - ab * ax) / det;
+    return true;
+}
+
+// Interpolated values: 8-value mode from the range of the block, then the
+// 6-value mode (with explicit 0 and 255) from the range of the other
+// values, then least-squares refinement and a search around the best
+// endpoints
+static void encode_channel_block(const BCnEncoder* encoder, const u8 values[16], bool is_signed, u8* out_data)
+{
+    BCnChannelSearch search;
+    search.encoder = encoder;
+    search.is_signed = is_signed;
+    search.error = ~0u;
+
+    u8 min = 255, max = 0;
+    u8 inner_min = 255, inner_max = 0;
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        const u8 value = values[k];
+        search.values[k] = value;
+
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+
+        if (value != 0 && value != 255)
+        {
+            inner_min = value < inner_min ? value : inner_min;
+            inner_max = value > inner_max ? value : inner_max;
+        }
+    }
+
+    try_channel_endpoints(&search, max, min);
+
+    if (encoder->quality != BCN_QUALITY_FAST && search.error != 0)
+    {
+        if (inner_min <= inner_max)
+            try_channel_endpoints(&search, inner_min, inner_max);
+        else
+            try_channel_endpoints(&search, 0, 0);
+
+        const u32 num_refinements = encoder->quality == BCN_QUALITY_HIGH ? 3 : 1;
+
+        for (u32 i = 0; i < num_refinements && search.error != 0; i++)
+        {
+            const u32 error = search.error;
+            f32 value_a, value_b;
+
+            if (!refine_channel_least_squares(&search, &value_a, &value_b))
+                break;
+
+            const u8 a = clamp_channel_value((s32)(value_a + 0.5f));
+            const u8 b = clamp_channel_value((s32)(value_b + 0.5f));
+
+            // Keep the mode of the endpoints being refined
+            if (search.value0 > search.value1)
+            {
+                if (a != b)
+                    try_channel_endpoints(&search, a > b ? a : b, a > b ? b : a);
+            }
+            else
+            {
+                try_channel_endpoints(&search, a > b ? b : a, a > b ? a : b);
+            }
+
+            if (search.error == error)
+                break;
+        }
+    }
+
+    if (encoder->quality == BCN_QUALITY_HIGH && search.error != 0)
+    {
+        for (u32 iter = 0; iter < 2; iter++)
+        {
+            const s32 value0 = search.value0;
+            const s32 value1 = search.value1;
+
+            for (s32 d0 = -2; d0 <= 2; d0++)
+                for (s32 d1 = -2; d1 <= 2; d1++)
+                    try_channel_endpoints(&search, clamp_channel_value(value0 + d0), clamp_channel_value(value1 + d1));
+
+            if (search.value0 == value0 && search.value1 == value1)
+                break;
+        }
+    }
+
+    // Signed endpoints are stored as two's complement
+    const u8 bias = is_signed ? 0x80 : 0;
+
+    out_data[0] = search.value0 ^ bias;
+    out_data[1] = search.value1 ^ bias;
+    for (u32 i = 0; i < 6; i++)
+        out_data[2 + i] = search.codes >> 8 * i & 0xFF;
+}
+
+// Gathers component comp of the texels of a block
+static inline void load_channel(const u8 texels[16][4], u32 comp, u8 values[16])
+{
+    for (u32 k = 0; k < 16; k++)
+        values[k] = texels[k][comp];
+}
+
+static void bc1_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data)
+{
+    encode_color_block(encoder, texels, true, out_data);
+}
+
+static void bc2_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data)
+{
+    encode_alpha_block_dxt3(texels, out_data);
+    encode_color_block(encoder, texels, false, out_data + 8);
+}
+
+static void bc3_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data)
+{
+    u8 alphas[16];
+    load_channel(texels, ACOMP, alphas);
+
+    encode_channel_block(encoder, alphas, false, out_data);
+    encode_color_block(encoder, texels, false, out_data + 8);
+}
+
+static inline void bc4_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data, bool is_signed)
+{
+    u8 reds[16];
+    load_channel(texels, RCOMP, reds);
+
+    encode_channel_block(encoder, reds, is_signed, out_data);
+}
+
+static inline void bc5_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data, bool is_signed)
+{
+    u8 reds[16];
+    u8 greens[16];
+    load_channel(texels, RCOMP, reds);
+    load_channel(texels, GCOMP, greens);
+
+    encode_channel_block(encoder, reds, is_signed, out_data);
+    encode_channel_block(encoder, greens, is_signed, out_data + 8);
+}
+
+static void bc4s_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data)
+{
+    bc4_encode_block(encoder, texels, out_data, true);
+}
+
+static void bc4u_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data)
+{
+    bc4_encode_block(encoder, texels, out_data, false);
+}
+
+static void bc5s_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data)
+{
+    bc5_encode_block(encoder, texels, out_data, true);
+}
+
+static void bc5u_encode_block(const BCnEncoder* encoder, const u8 texels[16][4], u8* out_data)
+{
+    bc5_encode_block(encoder, texels, out_data, false);
+}
+
+static BCnEncoder make_encoder(u32 block_size, BCnEncodeBlockFunc encode_block, BCnQuality quality)
+{
+    BCnEncoder encoder;
+    encoder.block_size = block_size;
+    encoder.encode_block = encode_block;
+    encoder.quality = quality;
+    encoder.color_indices = select_color_indices();
+    encoder.channel_codes = select_channel_codes();
+    return encoder;
+}
+
+// Gathers the texels of the block at (x, y), with coordinates outside the
+// image clamped to its edges
+static void load_block(u32 width, u32 height, const u8* in_data, u32 x, u32 y, u8 texels[16][4])
+{
+    for (u32 j = 0; j < 4; j++)
+    {
+        const u32 ty = y + j < height ? y + j : height - 1;
+
+        for (u32 i = 0; i < 4; i++)
+        {
+            const u32 tx = x + i < width ? x + i : width - 1;
+            memcpy(texels[j * 4 + i], in_data + ((size_t)ty * width + tx) * 4, 4);
+        }
+    }
+}
+
+// Encodes block rows [row_begin, row_end) of the image
+static void compress_rgba_rows(u32 width, u32 height, const u8* in_data, u8* out_data, const BCnEncoder* encoder,
+                               u32 row_begin, u32 row_end)
+{
+    const u32 num_blocks_x = (width + 3) / 4;
+    u8 texels[16][4];
+
+    for (u32 row = row_begin; row < row_end; row++)
+    {
+        u8* out_row = out_data + (size_t)row * num_blocks_x * encoder->block_size;
+
+        for (u32 block = 0; block < num_blocks_x; block++)
+        {
+            load_block(width, height, in_data, block * 4, row * 4, texels);
+            encoder->encode_block(encoder, (const u8 (*)[4])texels, out_row + block * encoder->block_size);
+        }
+    }
+}
+
+static void compress_rgba(u32 width, u32 height, const u8* in_data, u8* out_data, const BCnEncoder* encoder)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    compress_rgba_rows(width, height, in_data, out_data, encoder, 0, (height + 3) / 4);
+}
+
+// Images are split into bands of block rows of at least this many bytes of
+// input. Encoding is much slower than decoding, so bands are smaller than
+// those of decompress.c.
+#define BCN_COMPRESS_MIN_BAND_SIZE 0x10000
+
+typedef struct
+{
+    u32 width;
+    u32 height;
+    const u8* in_data;
+    u8* out_data;
+    const BCnEncoder* encoder;
+    u32 rows_per_band;
+    u32 num_rows;
+} BCnCompressJob;
+
+static void compress_rgba_band(void* user_data, u32 index)
+{
+    const BCnCompressJob* job = (const BCnCompressJob*)user_data;
+
+    const u32 row_begin = index * job->rows_per_band;
+    u32 row_end = row_begin + job->rows_per_band;
+    if (row_end > job->num_rows)
+        row_end = job->num_rows;
+
+    compress_rgba_rows(job->width, job->height, job->in_data, job->out_data, job->encoder, row_begin, row_end);
+}
+
+// Bands write to disjoint block rows of the output, so the result does not
+// depend on the number of threads or the order in which bands are encoded
+static void compress_rgba_parallel(u32 width, u32 height, const u8* in_data, u8* out_data, const BCnEncoder* encoder)
+{
+    const u32 num_rows = (height + 3) / 4;
+    const size_t row_size = (size_t)width * 4 * 4;
+
+    u32 rows_per_band = num_rows;
+    if (row_size * num_rows > BCN_COMPRESS_MIN_BAND_SIZE)
+        rows_per_band = (u32)((BCN_COMPRESS_MIN_BAND_SIZE + row_size - 1) / row_size);
+
+    if (rows_per_band >= num_rows)
+    {
+        compress_rgba(width, height, in_data, out_data, encoder);
+        return;
+    }
+
+    BCnCompressJob job;
+    job.width = width;
+    job.height = height;
+    job.in_data = in_data;
+    job.out_data = out_data;
+    job.encoder = encoder;
+    job.rows_per_band = rows_per_band;
+    job.num_rows = num_rows;
+
+    TexThreadPool_ParallelFor((num_rows + rows_per_band - 1) / rows_per_band, compress_rgba_band, &job);
+}
+
+void BCn_CompressBC1(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(8, bc1_encode_block, quality);
+    compress_rgba(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC2(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(16, bc2_encode_block, quality);
+    compress_rgba(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC3(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(16, bc3_encode_block, quality);
+    compress_rgba(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC4S(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(8, bc4s_encode_block, quality);
+    compress_rgba(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC4U(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(8, bc4u_encode_block, quality);
+    compress_rgba(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC5S(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(16, bc5s_encode_block, quality);
+    compress_rgba(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC5U(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(16, bc5u_encode_block, quality);
+    compress_rgba(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC1Parallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(8, bc1_encode_block, quality);
+    compress_rgba_parallel(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC2Parallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(16, bc2_encode_block, quality);
+    compress_rgba_parallel(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC3Parallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(16, bc3_encode_block, quality);
+    compress_rgba_parallel(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC4SParallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(8, bc4s_encode_block, quality);
+    compress_rgba_parallel(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC4UParallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(8, bc4u_encode_block, quality);
+    compress_rgba_parallel(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC5SParallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(16, bc5s_encode_block, quality);
+    compress_rgba_parallel(width, height, in_data, out_data, &encoder);
+}
+
+void BCn_CompressBC5UParallel(u32 width, u32 height, const u8* in_data, u8* out_data, BCnQuality quality)
+{
+    const BCnEncoder encoder = make_encoder(16, bc5u_encode_block, quality);
+    compress_rgba_parallel(width, height, in_data, out_data, &encoder);
+}
@@ -1,4 +1,16 @@
 #include <ninTexUtils/bcn/decompress.h>
+#include <ninTexUtils/cpu_features.h>
+#include <ninTexUtils/thread_pool.h>
+#include <assert.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define BCN_DECODE_KERNELS_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define BCN_DECODE_KERNELS_NEON 1
+    #include <arm_neon.h>
+#endif
 
 static inline u16 EXP5TO8R(u16 packedcol)
 {
@@ -25,276 +37,1390 @@ static inline u8 EXP4TO8(u8 col)
 #define BCOMP 2
 #define ACOMP 3
 
-static inline u32 dxt135_decode_imageblock(const u8* img_block_src, u32 i, u32 j, bool is_dxt1)
-{
-    u32 pixel;
-    u8* const pixel_U8 = (u8*)&pixel;
-    pixel_U8[ACOMP] = 255;
+// Blocks are decoded as a whole: the endpoints and the palette of a block
+// are computed once, then its 16 texels are looked up in the palette.
+// Decoded blocks are stored in row-major order.
 
+static inline void dxt135_decode_imageblock(const u8* img_block_src, u8 pixels[16][4], bool is_dxt1)
+{
     const u16 color0 = img_block_src[0] | img_block_src[1] << 8;
     const u16 color1 = img_block_src[2] | img_block_src[3] << 8;
 
     const u32 bits   = img_block_src[4]       | img_block_src[5] <<  8
-                     | img_block_src[6] << 16 | img_block_src[7] << 24;
-
-    const u8 bit_pos = 2 * (j * 4 + i);
-
-    switch (bits >> bit_pos & 3)
-    {
-    case 0:
-        pixel_U8[RCOMP] = EXP5TO8R(color0);
-        pixel_U8[GCOMP] = EXP6TO8G(color0);
-        pixel_U8[BCOMP] = EXP5TO8B(color0);
-        break;
-    case 1:
-        pixel_U8[RCOMP] = EXP5TO8R(color1);
-        pixel_U8[GCOMP] = EXP6TO8G(color1);
-        pixel_U8[BCOMP] = EXP5TO8B(color1);
-        break;
-    case 2:
-        if (color0 > color1)
-        {
-            pixel_U8[RCOMP] = (EXP5TO8R(color0) * 2 + EXP5TO8R(color1)) / 3;
-            pixel_U8[GCOMP] = (EXP6TO8G(color0) * 2 + EXP6TO8G(color1)) / 3;
-            pixel_U8[BCOMP] = (EXP5TO8B(color0) * 2 + EXP5TO8B(color1)) / 3;
-        }
-        else
-        {
-            pixel_U8[RCOMP] = (EXP5TO8R(color0) + EXP5TO8R(color1)) / 2;
-            pixel_U8[GCOMP] = (EXP6TO8G(color0) + EXP6TO8G(color1)) / 2;
-            pixel_U8[BCOMP] = (EXP5TO8B(color0) + EXP5TO8B(color1)) / 2;
-        }
-        break;
-    case 3:
-        if (!is_dxt1 || color0 > color1)
-        {
-            pixel_U8[RCOMP] = (EXP5TO8R(color0) + EXP5TO8R(color1) * 2) / 3;
-            pixel_U8[GCOMP] = (EXP6TO8G(color0) + EXP6TO8G(color1) * 2) / 3;
-            pixel_U8[BCOMP] = (EXP5TO8B(color0) + EXP5TO8B(color1) * 2) / 3;
-        }
-        else if (is_dxt1)
-        {
-            return 0;
-        }
+                     | img_block_src[6] << 16 | (u32)img_block_src[7] << 24;
+
+    const u8 r0 = EXP5TO8R(color0), g0 = EXP6TO8G(color0), b0 = EXP5TO8B(color0);
+    const u8 r1 = EXP5TO8R(color1), g1 = EXP6TO8G(color1), b1 = EXP5TO8B(color1);
+
+    u8 palette[4][4] = {
+        { r0, g0, b0, 255 },
+        { r1, g1, b1, 255 }
+    };
+
+    if (color0 > color1)
+    {
+        palette[2][RCOMP] = (r0 * 2 + r1) / 3;
+        palette[2][GCOMP] = (g0 * 2 + g1) / 3;
+        palette[2][BCOMP] = (b0 * 2 + b1) / 3;
+    }
+    else
+    {
+        palette[2][RCOMP] = (r0 + r1) / 2;
+        palette[2][GCOMP] = (g0 + g1) / 2;
+        palette[2][BCOMP] = (b0 + b1) / 2;
+    }
+    palette[2][ACOMP] = 255;
+
+    if (!is_dxt1 || color0 > color1)
+    {
+        palette[3][RCOMP] = (r0 + r1 * 2) / 3;
+        palette[3][GCOMP] = (g0 + g1 * 2) / 3;
+        palette[3][BCOMP] = (b0 + b1 * 2) / 3;
+        palette[3][ACOMP] = 255;
     }
+    else
+    {
+        // Punch-through alpha
+        palette[3][RCOMP] = 0;
+        palette[3][GCOMP] = 0;
+        palette[3][BCOMP] = 0;
+        palette[3][ACOMP] = 0;
+    }
+
+    for (u32 k = 0; k < 16; k++)
+        memcpy(pixels[k], palette[bits >> 2 * k & 3], 4);
+}
 
-    return pixel;
+static inline u64 dxt5_get_alphablock_codes(const u8* alpha_block_src)
+{
+    return (u64)alpha_block_src[2]       | (u64)alpha_block_src[3] <<  8
+         | (u64)alpha_block_src[4] << 16 | (u64)alpha_block_src[5] << 24
+         | (u64)alpha_block_src[6] << 32 | (u64)alpha_block_src[7] << 40;
 }
 
-static inline u8 dxt5_decode_alphablock(const u8* alpha_block_src, u32 i, u32 j)
+static inline void dxt5_decode_alphablock(const u8* alpha_block_src, u8 alphas[16])
 {
     const u8 alpha0 = alpha_block_src[0];
     const u8 alpha1 = alpha_block_src[1];
 
-    const u8 bit_pos   = 3 * (j * 4 + i);
-    const u8 acodelow  = alpha_block_src[2 + bit_pos / 8];
-    const u8 acodehigh = alpha_block_src[3 + bit_pos / 8];
+    u8 palette[8] = { alpha0, alpha1 };
 
-    const u8 code = (acodelow  >> (bit_pos & 7) |
-                     acodehigh << (8 - (bit_pos & 7))) & 7;
+    if (alpha0 > alpha1)
+    {
+        for (u32 code = 2; code < 8; code++)
+            palette[code] = (alpha0 * (8 - code) + alpha1 * (code - 1)) / 7;
+    }
+    else
+    {
+        for (u32 code = 2; code < 6; code++)
+            palette[code] = (alpha0 * (6 - code) + alpha1 * (code - 1)) / 5;
 
-    if (code == 0)
-        return alpha0;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
 
-    else if (code == 1)
-        return alpha1;
+    const u64 codes = dxt5_get_alphablock_codes(alpha_block_src);
 
-    else if (alpha0 > alpha1)
-        return (alpha0 * (8 - code) + alpha1 * (code - 1)) / 7;
+    for (u32 k = 0; k < 16; k++)
+        alphas[k] = palette[codes >> 3 * k & 7];
+}
 
-    else if (code < 6)
-        return (alpha0 * (6 - code) + alpha1 * (code - 1)) / 5;
+// Same as dxt5_decode_alphablock, for signed values, which are biased by
+// 128 in the output
+static inline void dxt5_decode_alphablock_signed(const u8* alpha_block_src, u8 alphas[16])
+{
+    const s8 alpha0 = alpha_block_src[0];
+    const s8 alpha1 = alpha_block_src[1];
+
+    u8 palette[8] = { (u8)(alpha0 + 128), (u8)(alpha1 + 128) };
+
+    if (alpha0 > alpha1)
+    {
+        for (s32 code = 2; code < 8; code++)
+            palette[code] = (alpha0 * (8 - code) + alpha1 * (code - 1)) / 7 + 128;
+    }
+    else
+    {
+        for (s32 code = 2; code < 6; code++)
+            palette[code] = (alpha0 * (6 - code) + alpha1 * (code - 1)) / 5 + 128;
+
+        palette[6] = 0;     // -128
+        palette[7] = 255;   //  127
+    }
 
-    else if (code == 6)
-        return 0;
+    const u64 codes = dxt5_get_alphablock_codes(alpha_block_src);
 
-    return 255;
+    for (u32 k = 0; k < 16; k++)
+        alphas[k] = palette[codes >> 3 * k & 7];
 }
 
-static inline s8 dxt5_decode_alphablock_signed(const u8* alpha_block_src, u32 i, u32 j)
+static inline void dxt3_decode_alphablock(const u8* alpha_block_src, u8 alphas[16])
 {
-    const s8 alpha0 = alpha_block_src[0];
-    const s8 alpha1 = alpha_block_src[1];
+    for (u32 k = 0; k < 16; k++)
+        alphas[k] = EXP4TO8(alpha_block_src[k / 2] >> 4 * (k & 1) & 0xF);
+}
 
-    const u8 bit_pos   = 3 * (j * 4 + i);
-    const u8 acodelow  = alpha_block_src[2 + bit_pos / 8];
-    const u8 acodehigh = alpha_block_src[3 + bit_pos / 8];
+// Writes the top-left block_width x block_height texels of a decoded block
+static inline void store_block_rgba(const u8* pixels, u8* out_data, u32 out_pitch, u32 block_width, u32 block_height)
+{
+    for (u32 j = 0; j < block_height; j++)
+        memcpy(out_data + j * out_pitch, pixels + j * 16, block_width * 4);
+}
 
-    const u8 code = (acodelow  >> (bit_pos & 7) |
-                     acodehigh << (8 - (bit_pos & 7))) & 7;
+static inline void bc1_decode_block(const u8* in_data, u8 pixels[16][4])
+{
+    dxt135_decode_imageblock(in_data, pixels, true);
+}
 
-    if (code == 0)
-        return alpha0;
+static inline void bc2_decode_block(const u8* in_data, u8 pixels[16][4])
+{
+    u8 alphas[16];
 
-    else if (code == 1)
-        return alpha1;
+    dxt135_decode_imageblock(in_data + 8, pixels, false);
+    dxt3_decode_alphablock(in_data, alphas);
 
-    else if (alpha0 > alpha1)
-        return (alpha0 * (8 - code) + alpha1 * (code - 1)) / 7;
+    for (u32 k = 0; k < 16; k++)
+        pixels[k][ACOMP] = alphas[k];
+}
 
-    else if (code < 6)
-        return (alpha0 * (6 - code) + alpha1 * (code - 1)) / 5;
+static inline void bc3_decode_block(const u8* in_data, u8 pixels[16][4])
+{
+    u8 alphas[16];
 
-    else if (code == 6)
-        return -128;
+    dxt135_decode_imageblock(in_data + 8, pixels, false);
+    dxt5_decode_alphablock(in_data, alphas);
 
-    return 127;
+    for (u32 k = 0; k < 16; k++)
+        pixels[k][ACOMP] = alphas[k];
 }
 
-static inline u32 fetch_2d_texel_rgba_dxt1(const u8* pixdata, u32 i, u32 j, u32 pitch)
+static inline void bc4_decode_block(const u8* in_data, u8 pixels[16][4], bool is_signed)
 {
-    const u8* blksrc = pixdata + 8 * ((j / 4) * pitch + (i / 4));
-    return dxt135_decode_imageblock(blksrc, i & 3, j & 3, true);
+    u8 reds[16];
+
+    if (is_signed)
+        dxt5_decode_alphablock_signed(in_data, reds);
+    else
+        dxt5_decode_alphablock(in_data, reds);
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        pixels[k][RCOMP] = reds[k];
+        pixels[k][GCOMP] = reds[k];
+        pixels[k][BCOMP] = reds[k];
+        pixels[k][ACOMP] = 255;
+    }
 }
 
-static inline u32 fetch_2d_texel_rgba_dxt3(const u8* pixdata, u32 i, u32 j, u32 pitch)
+static inline void bc5_decode_block(const u8* in_data, u8 pixels[16][4], bool is_signed)
 {
-    const u8* blksrc = pixdata + 16 * ((j / 4) * pitch + (i / 4));
-    u32 pixel = dxt135_decode_imageblock(blksrc + 8, i & 3, j & 3, false);
-    ((u8*)&pixel)[ACOMP] = EXP4TO8(blksrc[((j & 3) * 4 + (i & 3)) / 2] >> 4 * (i & 1) & 0xF);
-    return pixel;
+    u8 reds[16];
+    u8 greens[16];
+
+    if (is_signed)
+    {
+        dxt5_decode_alphablock_signed(in_data, reds);
+        dxt5_decode_alphablock_signed(in_data + 8, greens);
+    }
+    else
+    {
+        dxt5_decode_alphablock(in_data, reds);
+        dxt5_decode_alphablock(in_data + 8, greens);
+    }
+
+    for (u32 k = 0; k < 16; k++)
+    {
+        pixels[k][RCOMP] = reds[k];
+        pixels[k][GCOMP] = greens[k];
+        pixels[k][BCOMP] = 0;
+        pixels[k][ACOMP] = 255;
+    }
 }
 
-static inline u32 fetch_2d_texel_rgba_dxt5(const u8* pixdata, u32 i, u32 j, u32 pitch)
+static void bc4s_decode_block(const u8* in_data, u8 pixels[16][4])
 {
-    const u8* blksrc = pixdata + 16 * ((j / 4) * pitch + (i / 4));
-    u32 pixel = dxt135_decode_imageblock(blksrc + 8, i & 3, j & 3, false);
-    ((u8*)&pixel)[ACOMP] = dxt5_decode_alphablock(blksrc, i & 3, j & 3);
-    return pixel;
+    bc4_decode_block(in_data, pixels, true);
 }
 
-static inline u8 fetch_2d_texel_r_bc4(const u8* pixdata, u32 i, u32 j, u32 pitch)
+static void bc4u_decode_block(const u8* in_data, u8 pixels[16][4])
 {
-    const u8* blksrc = pixdata + 8 * ((j / 4) * pitch + (i / 4));
-    return dxt5_decode_alphablock(blksrc, i & 3, j & 3);
+    bc4_decode_block(in_data, pixels, false);
 }
 
-static inline u8 fetch_2d_texel_r_bc4_signed(const u8* pixdata, u32 i, u32 j, u32 pitch)
+static void bc5s_decode_block(const u8* in_data, u8 pixels[16][4])
 {
-    const u8* blksrc = pixdata + 8 * ((j / 4) * pitch + (i / 4));
-    return dxt5_decode_alphablock_signed(blksrc, i & 3, j & 3) + 128;
+    bc5_decode_block(in_data, pixels, true);
 }
 
-static inline u16 fetch_2d_texel_rg_bc5(const u8* pixdata, u32 i, u32 j, u32 pitch)
+static void bc5u_decode_block(const u8* in_data, u8 pixels[16][4])
 {
-    const u8* blksrc = pixdata + 16 * ((j / 4) * pitch + (i / 4));
-    u16 pixel;
-    ((u8*)&pixel)[RCOMP] = dxt5_decode_alphablock(blksrc, i & 3, j & 3);
-    ((u8*)&pixel)[GCOMP] = dxt5_decode_alphablock(blksrc + 8, i & 3, j & 3);
-    return pixel;
+    bc5_decode_block(in_data, pixels, false);
 }
 
-static inline u16 fetch_2d_texel_rg_bc5_signed(const u8* pixdata, u32 i, u32 j, u32 pitch)
+typedef void (*BCnDecodeBlockFunc)(const u8* in_data, u8 pixels[16][4]);
+
+// Decodes num_blocks consecutive blocks of a block row, none of which
+// crosses the edges of the image, straight to the output.
+// out_data points to the top-left texel of the first block and out_pitch
+// is the size of a row of the output, in bytes.
+typedef void (*BCnDecodeBlocksFunc)(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks);
+
+static inline void decode_blocks_generic(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks,
+                                         u32 block_size, BCnDecodeBlockFunc decode_block)
 {
-    const u8* blksrc = pixdata + 16 * ((j / 4) * pitch + (i / 4));
-    u16 pixel;
-    ((u8*)&pixel)[RCOMP] = dxt5_decode_alphablock_signed(blksrc, i & 3, j & 3) + 128;
-    ((u8*)&pixel)[GCOMP] = dxt5_decode_alphablock_signed(blksrc + 8, i & 3, j & 3) + 128;
-    return pixel;
+    u8 pixels[16][4];
+
+    for (u32 block = 0; block < num_blocks; block++)
+    {
+        decode_block(in_data + block * block_size, pixels);
+
+        for (u32 j = 0; j < 4; j++)
+            memcpy(out_data + block * 16 + j * out_pitch, pixels[j * 4], 16);
+    }
 }
 
-void BCn_DecompressBC1(u32 width, u32 height, const u8* in_data, u8* out_data)
+static void bc1_decode_blocks_generic(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
 {
-    u32 pitch = (width + 3) >> 2;
-    u32* out_rgba_data = (u32*)out_data;
+    decode_blocks_generic(in_data, out_data, out_pitch, num_blocks, 8, bc1_decode_block);
+}
 
-    for (u32 y = 0; y < height; y++)
-        for (u32 x = 0; x < width; x++)
-            *out_rgba_data++ = fetch_2d_texel_rgba_dxt1(in_data, x, y, pitch);
+static void bc2_decode_blocks_generic(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    decode_blocks_generic(in_data, out_data, out_pitch, num_blocks, 16, bc2_decode_block);
 }
 
-void BCn_DecompressBC2(u32 width, u32 height, const u8* in_data, u8* out_data)
+static void bc3_decode_blocks_generic(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
 {
-    u32 pitch = (width + 3) >> 2;
-    u32* out_rgba_data = (u32*)out_data;
+    decode_blocks_generic(in_data, out_data, out_pitch, num_blocks, 16, bc3_decode_block);
+}
 
-    for (u32 y = 0; y < height; y++)
-        for (u32 x = 0; x < width; x++)
-            *out_rgba_data++ = fetch_2d_texel_rgba_dxt3(in_data, x, y, pitch);
+static void bc4s_decode_blocks_generic(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    decode_blocks_generic(in_data, out_data, out_pitch, num_blocks, 8, bc4s_decode_block);
 }
 
-void BCn_DecompressBC3(u32 width, u32 height, const u8* in_data, u8* out_data)
+static void bc4u_decode_blocks_generic(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
 {
-    u32 pitch = (width + 3) >> 2;
-    u32* out_rgba_data = (u32*)out_data;
+    decode_blocks_generic(in_data, out_data, out_pitch, num_blocks, 8, bc4u_decode_block);
+}
 
-    for (u32 y = 0; y < height; y++)
-        for (u32 x = 0; x < width; x++)
-            *out_rgba_data++ = fetch_2d_texel_rgba_dxt5(in_data, x, y, pitch);
+static void bc5s_decode_blocks_generic(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    decode_blocks_generic(in_data, out_data, out_pitch, num_blocks, 16, bc5s_decode_block);
 }
 
-void BCn_DecompressBC4S(u32 width, u32 height, const u8* in_data, u8* out_data)
+static void bc5u_decode_blocks_generic(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    decode_blocks_generic(in_data, out_data, out_pitch, num_blocks, 16, bc5u_decode_block);
+}
+
+// SIMD decoders.
+// Color blocks are decoded several at a time: the endpoints of all blocks
+// are expanded and interpolated together, with the 16-bit channels of
+// color0 and color1 of each block in the low and high halves of a 32-bit
+// lane, then each block's palette is transposed to 16 bytes (4 RGBA
+// entries), which the texels' 2-bit indices select from with a byte
+// shuffle. Alpha blocks (and BC4/BC5 channel blocks) are decoded one at a
+// time, to 16 bytes, from a palette built once per block.
+// All divisions are exact multiplications by reciprocals over the range
+// of their operands, so results are identical to the scalar code.
+
+#if defined(BCN_DECODE_KERNELS_X86)
+
+// Interpolates one channel of the endpoints of 4 color blocks.
+// Returns palette entries 0 to 3 in the bytes of each block's lane.
+static inline CPU_FEATURES_TARGET_SSE41 __m128i dxt135_interpolate_sse41(__m128i x, __m128i gt, bool is_dxt1)
+{
+    const __m128i xs = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+
+    // (2 * x0 + x1) / 3, (x0 + 2 * x1) / 3
+    const __m128i thirds = _mm_srli_epi16(_mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(x, x), xs),
+                                                          _mm_set1_epi16((short)0xAAAB)), 1);
+
+    // (x0 + x1) / 2, then 0 (punch-through) or (x0 + 2 * x1) / 3
+    const __m128i halves = _mm_srli_epi16(_mm_add_epi16(x, xs), 1);
+    const __m128i others = is_dxt1 ? _mm_and_si128(halves, _mm_set1_epi32(0xFFFF))
+                                   : _mm_blend_epi16(halves, thirds, 0xAA);
+
+    const __m128i entries23 = _mm_blendv_epi8(others, thirds, gt);
+
+    return _mm_shuffle_epi8(_mm_packus_epi16(x, entries23),
+                            _mm_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15));
+}
+
+// Palettes of 4 color blocks, given color0 | color1 << 16 of each block.
+// For BC2 and BC3, the alpha of all entries is 0, to be replaced.
+static inline CPU_FEATURES_TARGET_SSE41 void dxt135_decode_palettes_sse41(__m128i colors, bool is_dxt1, __m128i palettes[4])
+{
+    const __m128i r = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(colors,  8), _mm_set1_epi16(0xF8)),
+                                                 _mm_srli_epi16(colors, 13));
+    const __m128i g = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(colors,  3), _mm_set1_epi16(0xFC)),
+                                   _mm_and_si128(_mm_srli_epi16(colors,  9), _mm_set1_epi16(0x03)));
+    const __m128i b = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(colors,  3), _mm_set1_epi16(0xF8)),
+                                   _mm_and_si128(_mm_srli_epi16(colors,  2), _mm_set1_epi16(0x07)));
+
+    // color0 > color1
+    const __m128i gt = _mm_cmpgt_epi32(_mm_and_si128(colors, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(colors, 16));
+
+    const __m128i r_entries = dxt135_interpolate_sse41(r, gt, is_dxt1);
+    const __m128i g_entries = dxt135_interpolate_sse41(g, gt, is_dxt1);
+    const __m128i b_entries = dxt135_interpolate_sse41(b, gt, is_dxt1);
+    const __m128i a_entries = is_dxt1 ? _mm_or_si128(_mm_set1_epi32(0x00FFFFFF), _mm_and_si128(gt, _mm_set1_epi32((int)0xFF000000)))
+                                      : _mm_setzero_si128();
+
+    const __m128i rg_lo = _mm_unpacklo_epi8(r_entries, g_entries);
+    const __m128i rg_hi = _mm_unpackhi_epi8(r_entries, g_entries);
+    const __m128i ba_lo = _mm_unpacklo_epi8(b_entries, a_entries);
+    const __m128i ba_hi = _mm_unpackhi_epi8(b_entries, a_entries);
+
+    palettes[0] = _mm_unpacklo_epi16(rg_lo, ba_lo);
+    palettes[1] = _mm_unpackhi_epi16(rg_lo, ba_lo);
+    palettes[2] = _mm_unpacklo_epi16(rg_hi, ba_hi);
+    palettes[3] = _mm_unpackhi_epi16(rg_hi, ba_hi);
+}
+
+// Rows of the block with the given palette whose indices are in lane k of bits
+static inline CPU_FEATURES_TARGET_SSE41 void dxt135_lookup_texels_sse41(__m128i palette, __m128i bits, u32 k, __m128i rows[4])
 {
-    u32 pitch = (width + 3) >> 2;
+    // Byte 4 * j + i: row j of indices, then index of texel (i, j)
+    const __m128i row_bits = _mm_shuffle_epi8(bits, _mm_add_epi8(_mm_set1_epi8((char)(4 * k)),
+                                                                 _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3)));
+
+    __m128i indices =           _mm_and_si128(row_bits,                     _mm_set1_epi32(0x00000003));
+    indices = _mm_or_si128(indices, _mm_and_si128(_mm_srli_epi16(row_bits, 2), _mm_set1_epi32(0x00000300)));
+    indices = _mm_or_si128(indices, _mm_and_si128(_mm_srli_epi16(row_bits, 4), _mm_set1_epi32(0x00030000)));
+    indices = _mm_or_si128(indices, _mm_and_si128(_mm_srli_epi16(row_bits, 6), _mm_set1_epi32(0x03000000)));
 
-    for (u32 y = 0; y < height; y++)
+    const __m128i offsets = _mm_slli_epi16(indices, 2);
+
+    for (u32 j = 0; j < 4; j++)
     {
-        for (u32 x = 0; x < width; x++)
-        {
-            u8 R = fetch_2d_texel_r_bc4_signed(in_data, x, y, pitch);
+        const __m128i texel_offsets = _mm_shuffle_epi8(offsets, _mm_add_epi8(_mm_set1_epi8((char)(4 * j)),
+                                                                             _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3)));
 
-            out_data[RCOMP] = R;
-            out_data[GCOMP] = R;
-            out_data[BCOMP] = R;
-            out_data[ACOMP] = 255;
-            out_data += 4;
-        }
+        rows[j] = _mm_shuffle_epi8(palette, _mm_add_epi8(texel_offsets, _mm_set1_epi32(0x03020100)));
     }
 }
 
-void BCn_DecompressBC4U(u32 width, u32 height, const u8* in_data, u8* out_data)
+static inline CPU_FEATURES_TARGET_SSE41 __m128i dxt3_decode_alphablock_sse41(__m128i block)
+{
+    const __m128i nibbles = _mm_unpacklo_epi8(_mm_and_si128(block, _mm_set1_epi8(0x0F)),
+                                              _mm_and_si128(_mm_srli_epi16(block, 4), _mm_set1_epi8(0x0F)));
+
+    return _mm_or_si128(nibbles, _mm_slli_epi16(nibbles, 4));
+}
+
+// Divides the weighted sums of two alpha values by 7 or 5 (given as magic)
+// For signed values, the division truncates towards 0 and the quotient is
+// biased by 128
+static inline CPU_FEATURES_TARGET_SSE41 __m128i dxt5_divide_sse41(__m128i sums, __m128i magic, bool is_signed)
+{
+    if (!is_signed)
+        return _mm_mulhi_epu16(sums, magic);
+
+    return _mm_add_epi16(_mm_sign_epi16(_mm_mulhi_epu16(_mm_abs_epi16(sums), magic), sums),
+                         _mm_set1_epi16(128));
+}
+
+static inline CPU_FEATURES_TARGET_SSE41 __m128i dxt5_decode_alphablock_sse41(__m128i block, bool is_signed)
+{
+    __m128i alpha0 = _mm_shuffle_epi8(block, _mm_set1_epi16((short)0x8000));
+    __m128i alpha1 = _mm_shuffle_epi8(block, _mm_set1_epi16((short)0x8001));
+
+    if (is_signed)
+    {
+        alpha0 = _mm_srai_epi16(_mm_slli_epi16(alpha0, 8), 8);
+        alpha1 = _mm_srai_epi16(_mm_slli_epi16(alpha1, 8), 8);
+    }
+
+    // Codes 0 to 7, for alpha0 > alpha1
+    const __m128i sevenths = dxt5_divide_sse41(_mm_add_epi16(_mm_mullo_epi16(alpha0, _mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1)),
+                                                             _mm_mullo_epi16(alpha1, _mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6))),
+                                               _mm_set1_epi16(0x2493), is_signed);
+
+    // Codes 0 to 7, for alpha0 <= alpha1
+    __m128i fifths = dxt5_divide_sse41(_mm_add_epi16(_mm_mullo_epi16(alpha0, _mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0)),
+                                                     _mm_mullo_epi16(alpha1, _mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0))),
+                                       _mm_set1_epi16(0x3334), is_signed);
+    fifths = _mm_blend_epi16(fifths, _mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255), 0xC0);
+
+    const __m128i palette = _mm_packus_epi16(_mm_blendv_epi8(fifths, sevenths, _mm_cmpgt_epi16(alpha0, alpha1)),
+                                             _mm_setzero_si128());
+
+    // Code of texel k: 2 bytes holding bits 3k to 3k + 2 of the codes,
+    // shifted so that these end up in bits 13 to 15
+    const __m128i shifts = _mm_setr_epi16(1 << 13, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8);
+
+    const __m128i codes_lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(block, _mm_setr_epi8(2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5)),
+                                                            shifts), 13);
+    const __m128i codes_hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(block, _mm_setr_epi8(5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, 8, 7, 8)),
+                                                            shifts), 13);
+
+    return _mm_shuffle_epi8(palette, _mm_packus_epi16(codes_lo, codes_hi));
+}
+
+// Replaces the alpha of the rows of a block with 16 alpha values
+static inline CPU_FEATURES_TARGET_SSE41 void insert_alphas_sse41(__m128i rows[4], __m128i alphas)
+{
+    for (u32 j = 0; j < 4; j++)
+        rows[j] = _mm_or_si128(rows[j], _mm_shuffle_epi8(alphas, _mm_add_epi8(_mm_set1_epi32((int)(0x01000000 * 4 * j)),
+                                                                              _mm_setr_epi8(-1, -1, -1, 0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3))));
+}
+
+static inline CPU_FEATURES_TARGET_SSE41 void store_rows_sse41(u8* out_data, u32 out_pitch, const __m128i rows[4])
 {
-    u32 pitch = (width + 3) >> 2;
+    for (u32 j = 0; j < 4; j++)
+        _mm_storeu_si128((__m128i*)(out_data + j * out_pitch), rows[j]);
+}
+
+static CPU_FEATURES_TARGET_SSE41 void bc1_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    u32 block = 0;
 
-    for (u32 y = 0; y < height; y++)
+    for (; block + 4 <= num_blocks; block += 4)
     {
-        for (u32 x = 0; x < width; x++)
+        const __m128 blocks01 = _mm_loadu_ps((const float*)(in_data + block * 8));
+        const __m128 blocks23 = _mm_loadu_ps((const float*)(in_data + block * 8 + 16));
+
+        const __m128i colors = _mm_castps_si128(_mm_shuffle_ps(blocks01, blocks23, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i bits   = _mm_castps_si128(_mm_shuffle_ps(blocks01, blocks23, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        __m128i palettes[4];
+        dxt135_decode_palettes_sse41(colors, true, palettes);
+
+        for (u32 k = 0; k < 4; k++)
         {
-            u8 R = fetch_2d_texel_r_bc4(in_data, x, y, pitch);
+            __m128i rows[4];
+            dxt135_lookup_texels_sse41(palettes[k], bits, k, rows);
+            store_rows_sse41(out_data + (block + k) * 16, out_pitch, rows);
+        }
+    }
+
+    bc1_decode_blocks_generic(in_data + block * 8, out_data + block * 16, out_pitch, num_blocks - block);
+}
+
+static inline CPU_FEATURES_TARGET_SSE41 void bc23_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_dxt5)
+{
+    u32 block = 0;
+
+    for (; block + 4 <= num_blocks; block += 4)
+    {
+        __m128i blocks[4];
+        for (u32 k = 0; k < 4; k++)
+            blocks[k] = _mm_loadu_si128((const __m128i*)(in_data + (block + k) * 16));
+
+        const __m128 color_blocks01 = _mm_castsi128_ps(_mm_unpackhi_epi64(blocks[0], blocks[1]));
+        const __m128 color_blocks23 = _mm_castsi128_ps(_mm_unpackhi_epi64(blocks[2], blocks[3]));
+
+        const __m128i colors = _mm_castps_si128(_mm_shuffle_ps(color_blocks01, color_blocks23, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i bits   = _mm_castps_si128(_mm_shuffle_ps(color_blocks01, color_blocks23, _MM_SHUFFLE(3, 1, 3, 1)));
 
-            out_data[RCOMP] = R;
-            out_data[GCOMP] = R;
-            out_data[BCOMP] = R;
-            out_data[ACOMP] = 255;
-            out_data += 4;
+        __m128i palettes[4];
+        dxt135_decode_palettes_sse41(colors, false, palettes);
+
+        for (u32 k = 0; k < 4; k++)
+        {
+            __m128i rows[4];
+            dxt135_lookup_texels_sse41(palettes[k], bits, k, rows);
+            insert_alphas_sse41(rows, is_dxt5 ? dxt5_decode_alphablock_sse41(blocks[k], false)
+                                              : dxt3_decode_alphablock_sse41(blocks[k]));
+            store_rows_sse41(out_data + (block + k) * 16, out_pitch, rows);
         }
     }
+
+    if (is_dxt5)
+        bc3_decode_blocks_generic(in_data + block * 16, out_data + block * 16, out_pitch, num_blocks - block);
+    else
+        bc2_decode_blocks_generic(in_data + block * 16, out_data + block * 16, out_pitch, num_blocks - block);
 }
 
-void BCn_DecompressBC5S(u32 width, u32 height, const u8* in_data, u8* out_data)
+static CPU_FEATURES_TARGET_SSE41 void bc2_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc23_decode_blocks_sse41(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+static CPU_FEATURES_TARGET_SSE41 void bc3_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc23_decode_blocks_sse41(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+// Expands the values of a BC4 block to R, R, R, 255 and those of the two
+// halves of a BC5 block to R, G, 0, 255
+
+static inline CPU_FEATURES_TARGET_SSE41 void bc4_expand_rows_sse41(__m128i reds, __m128i rows[4])
+{
+    for (u32 j = 0; j < 4; j++)
+        rows[j] = _mm_or_si128(_mm_shuffle_epi8(reds, _mm_add_epi8(_mm_set1_epi8((char)(4 * j)),
+                                                                   _mm_setr_epi8(0, 0, 0, -128, 1, 1, 1, -128, 2, 2, 2, -128, 3, 3, 3, -128))),
+                               _mm_set1_epi32((int)0xFF000000));
+}
+
+static inline CPU_FEATURES_TARGET_SSE41 void bc5_expand_rows_sse41(__m128i reds, __m128i greens, __m128i rows[4])
 {
-    u32 pitch = (width + 3) >> 2;
+    const __m128i rg_lo = _mm_unpacklo_epi8(reds, greens);
+    const __m128i rg_hi = _mm_unpackhi_epi8(reds, greens);
+    const __m128i ba = _mm_set1_epi16((short)0xFF00);
+
+    rows[0] = _mm_unpacklo_epi16(rg_lo, ba);
+    rows[1] = _mm_unpackhi_epi16(rg_lo, ba);
+    rows[2] = _mm_unpacklo_epi16(rg_hi, ba);
+    rows[3] = _mm_unpackhi_epi16(rg_hi, ba);
+}
 
-    for (u32 y = 0; y < height; y++)
+static inline CPU_FEATURES_TARGET_SSE41 void bc4_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_signed)
+{
+    for (u32 block = 0; block < num_blocks; block++)
+    {
+        __m128i rows[4];
+        bc4_expand_rows_sse41(dxt5_decode_alphablock_sse41(_mm_loadl_epi64((const __m128i*)(in_data + block * 8)), is_signed), rows);
+        store_rows_sse41(out_data + block * 16, out_pitch, rows);
+    }
+}
+
+static inline CPU_FEATURES_TARGET_SSE41 void bc5_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_signed)
+{
+    for (u32 block = 0; block < num_blocks; block++)
     {
-        for (u32 x = 0; x < width; x++)
+        const __m128i blocks = _mm_loadu_si128((const __m128i*)(in_data + block * 16));
+
+        __m128i rows[4];
+        bc5_expand_rows_sse41(dxt5_decode_alphablock_sse41(blocks, is_signed),
+                              dxt5_decode_alphablock_sse41(_mm_srli_si128(blocks, 8), is_signed), rows);
+        store_rows_sse41(out_data + block * 16, out_pitch, rows);
+    }
+}
+
+static CPU_FEATURES_TARGET_SSE41 void bc4s_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc4_decode_blocks_sse41(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+static CPU_FEATURES_TARGET_SSE41 void bc4u_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc4_decode_blocks_sse41(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+static CPU_FEATURES_TARGET_SSE41 void bc5s_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc5_decode_blocks_sse41(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+static CPU_FEATURES_TARGET_SSE41 void bc5u_decode_blocks_sse41(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc5_decode_blocks_sse41(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+// The AVX2 color decoders work on 8 blocks at a time, in the same way as
+// the SSE4.1 decoders, with blocks 2k and 2k + 1 in the low and high lanes
+// of the k-th palette. The BC4 and BC5 decoders work on 2 blocks at a time,
+// one per lane.
+
+#define BCN_BROADCAST128(x) _mm256_broadcastsi128_si256(x)
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i dxt135_interpolate_avx2(__m256i x, __m256i gt, bool is_dxt1)
+{
+    const __m256i xs = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+
+    const __m256i thirds = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_add_epi16(_mm256_add_epi16(x, x), xs),
+                                                                _mm256_set1_epi16((short)0xAAAB)), 1);
+
+    const __m256i halves = _mm256_srli_epi16(_mm256_add_epi16(x, xs), 1);
+    const __m256i others = is_dxt1 ? _mm256_and_si256(halves, _mm256_set1_epi32(0xFFFF))
+                                   : _mm256_blend_epi16(halves, thirds, 0xAA);
+
+    const __m256i entries23 = _mm256_blendv_epi8(others, thirds, gt);
+
+    return _mm256_shuffle_epi8(_mm256_packus_epi16(x, entries23),
+                               BCN_BROADCAST128(_mm_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15)));
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 void dxt135_decode_palettes_avx2(__m256i colors, bool is_dxt1, __m256i palettes[4])
+{
+    const __m256i r = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(colors,  8), _mm256_set1_epi16(0xF8)),
+                                                       _mm256_srli_epi16(colors, 13));
+    const __m256i g = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(colors,  3), _mm256_set1_epi16(0xFC)),
+                                      _mm256_and_si256(_mm256_srli_epi16(colors,  9), _mm256_set1_epi16(0x03)));
+    const __m256i b = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(colors,  3), _mm256_set1_epi16(0xF8)),
+                                      _mm256_and_si256(_mm256_srli_epi16(colors,  2), _mm256_set1_epi16(0x07)));
+
+    const __m256i gt = _mm256_cmpgt_epi32(_mm256_and_si256(colors, _mm256_set1_epi32(0xFFFF)), _mm256_srli_epi32(colors, 16));
+
+    const __m256i r_entries = dxt135_interpolate_avx2(r, gt, is_dxt1);
+    const __m256i g_entries = dxt135_interpolate_avx2(g, gt, is_dxt1);
+    const __m256i b_entries = dxt135_interpolate_avx2(b, gt, is_dxt1);
+    const __m256i a_entries = is_dxt1 ? _mm256_or_si256(_mm256_set1_epi32(0x00FFFFFF), _mm256_and_si256(gt, _mm256_set1_epi32((int)0xFF000000)))
+                                      : _mm256_setzero_si256();
+
+    const __m256i rg_lo = _mm256_unpacklo_epi8(r_entries, g_entries);
+    const __m256i rg_hi = _mm256_unpackhi_epi8(r_entries, g_entries);
+    const __m256i ba_lo = _mm256_unpacklo_epi8(b_entries, a_entries);
+    const __m256i ba_hi = _mm256_unpackhi_epi8(b_entries, a_entries);
+
+    palettes[0] = _mm256_unpacklo_epi16(rg_lo, ba_lo);
+    palettes[1] = _mm256_unpackhi_epi16(rg_lo, ba_lo);
+    palettes[2] = _mm256_unpacklo_epi16(rg_hi, ba_hi);
+    palettes[3] = _mm256_unpackhi_epi16(rg_hi, ba_hi);
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 void dxt135_lookup_texels_avx2(__m256i palette, __m256i bits, u32 k, __m256i rows[4])
+{
+    const __m256i row_bits = _mm256_shuffle_epi8(bits, _mm256_add_epi8(_mm256_set1_epi8((char)(4 * k)),
+                                                                       BCN_BROADCAST128(_mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3))));
+
+    __m256i indices =              _mm256_and_si256(row_bits,                        _mm256_set1_epi32(0x00000003));
+    indices = _mm256_or_si256(indices, _mm256_and_si256(_mm256_srli_epi16(row_bits, 2), _mm256_set1_epi32(0x00000300)));
+    indices = _mm256_or_si256(indices, _mm256_and_si256(_mm256_srli_epi16(row_bits, 4), _mm256_set1_epi32(0x00030000)));
+    indices = _mm256_or_si256(indices, _mm256_and_si256(_mm256_srli_epi16(row_bits, 6), _mm256_set1_epi32(0x03000000)));
+
+    const __m256i offsets = _mm256_slli_epi16(indices, 2);
+
+    for (u32 j = 0; j < 4; j++)
+    {
+        const __m256i texel_offsets = _mm256_shuffle_epi8(offsets, _mm256_add_epi8(_mm256_set1_epi8((char)(4 * j)),
+                                                                                   BCN_BROADCAST128(_mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3))));
+
+        rows[j] = _mm256_shuffle_epi8(palette, _mm256_add_epi8(texel_offsets, _mm256_set1_epi32(0x03020100)));
+    }
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i dxt3_decode_alphablocks_avx2(__m256i blocks)
+{
+    const __m256i nibbles = _mm256_unpacklo_epi8(_mm256_and_si256(blocks, _mm256_set1_epi8(0x0F)),
+                                                 _mm256_and_si256(_mm256_srli_epi16(blocks, 4), _mm256_set1_epi8(0x0F)));
+
+    return _mm256_or_si256(nibbles, _mm256_slli_epi16(nibbles, 4));
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i dxt5_divide_avx2(__m256i sums, __m256i magic, bool is_signed)
+{
+    if (!is_signed)
+        return _mm256_mulhi_epu16(sums, magic);
+
+    return _mm256_add_epi16(_mm256_sign_epi16(_mm256_mulhi_epu16(_mm256_abs_epi16(sums), magic), sums),
+                            _mm256_set1_epi16(128));
+}
+
+// Decodes the alpha blocks at the start of both lanes
+static inline CPU_FEATURES_TARGET_AVX2 __m256i dxt5_decode_alphablocks_avx2(__m256i blocks, bool is_signed)
+{
+    __m256i alpha0 = _mm256_shuffle_epi8(blocks, _mm256_set1_epi16((short)0x8000));
+    __m256i alpha1 = _mm256_shuffle_epi8(blocks, _mm256_set1_epi16((short)0x8001));
+
+    if (is_signed)
+    {
+        alpha0 = _mm256_srai_epi16(_mm256_slli_epi16(alpha0, 8), 8);
+        alpha1 = _mm256_srai_epi16(_mm256_slli_epi16(alpha1, 8), 8);
+    }
+
+    const __m256i sevenths = dxt5_divide_avx2(_mm256_add_epi16(_mm256_mullo_epi16(alpha0, BCN_BROADCAST128(_mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1))),
+                                                               _mm256_mullo_epi16(alpha1, BCN_BROADCAST128(_mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6)))),
+                                              _mm256_set1_epi16(0x2493), is_signed);
+
+    __m256i fifths = dxt5_divide_avx2(_mm256_add_epi16(_mm256_mullo_epi16(alpha0, BCN_BROADCAST128(_mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0))),
+                                                       _mm256_mullo_epi16(alpha1, BCN_BROADCAST128(_mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0)))),
+                                      _mm256_set1_epi16(0x3334), is_signed);
+    fifths = _mm256_blend_epi16(fifths, BCN_BROADCAST128(_mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255)), 0xC0);
+
+    const __m256i palettes = _mm256_packus_epi16(_mm256_blendv_epi8(fifths, sevenths, _mm256_cmpgt_epi16(alpha0, alpha1)),
+                                                 _mm256_setzero_si256());
+
+    const __m256i shifts = BCN_BROADCAST128(_mm_setr_epi16(1 << 13, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8));
+
+    const __m256i codes_lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_shuffle_epi8(blocks, BCN_BROADCAST128(_mm_setr_epi8(2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5))),
+                                                                  shifts), 13);
+    const __m256i codes_hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_shuffle_epi8(blocks, BCN_BROADCAST128(_mm_setr_epi8(5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, 8, 7, 8))),
+                                                                  shifts), 13);
+
+    return _mm256_shuffle_epi8(palettes, _mm256_packus_epi16(codes_lo, codes_hi));
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 void insert_alphas_avx2(__m256i rows[4], __m256i alphas)
+{
+    for (u32 j = 0; j < 4; j++)
+        rows[j] = _mm256_or_si256(rows[j], _mm256_shuffle_epi8(alphas, _mm256_add_epi8(_mm256_set1_epi32((int)(0x01000000 * 4 * j)),
+                                                                                       BCN_BROADCAST128(_mm_setr_epi8(-1, -1, -1, 0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3)))));
+}
+
+// Blocks 2k and 2k + 1 are next to each other in the output
+static inline CPU_FEATURES_TARGET_AVX2 void store_rows_avx2(u8* out_data, u32 out_pitch, const __m256i rows[4])
+{
+    for (u32 j = 0; j < 4; j++)
+        _mm256_storeu_si256((__m256i*)(out_data + j * out_pitch), rows[j]);
+}
+
+static CPU_FEATURES_TARGET_AVX2 void bc1_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    u32 block = 0;
+
+    for (; block + 8 <= num_blocks; block += 8)
+    {
+        // Blocks 0, 2 | 1, 3 and 4, 6 | 5, 7
+        const __m256 blocks0123 = _mm256_castsi256_ps(_mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(in_data + block * 8)),      _MM_SHUFFLE(3, 1, 2, 0)));
+        const __m256 blocks4567 = _mm256_castsi256_ps(_mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(in_data + block * 8 + 32)), _MM_SHUFFLE(3, 1, 2, 0)));
+
+        const __m256i colors = _mm256_castps_si256(_mm256_shuffle_ps(blocks0123, blocks4567, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m256i bits   = _mm256_castps_si256(_mm256_shuffle_ps(blocks0123, blocks4567, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        __m256i palettes[4];
+        dxt135_decode_palettes_avx2(colors, true, palettes);
+
+        for (u32 k = 0; k < 4; k++)
         {
-            u16 RG = fetch_2d_texel_rg_bc5_signed(in_data, x, y, pitch);
+            __m256i rows[4];
+            dxt135_lookup_texels_avx2(palettes[k], bits, k, rows);
+            store_rows_avx2(out_data + (block + 2 * k) * 16, out_pitch, rows);
+        }
+    }
+
+    bc1_decode_blocks_sse41(in_data + block * 8, out_data + block * 16, out_pitch, num_blocks - block);
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 void bc23_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_dxt5)
+{
+    u32 block = 0;
 
-            out_data[RCOMP] = ((u8*)&RG)[RCOMP];
-            out_data[GCOMP] = ((u8*)&RG)[GCOMP];
-            out_data[BCOMP] = 0;
-            out_data[ACOMP] = 255;
-            out_data += 4;
+    for (; block + 8 <= num_blocks; block += 8)
+    {
+        // Blocks 2k | 2k + 1
+        __m256i blocks[4];
+        for (u32 k = 0; k < 4; k++)
+            blocks[k] = _mm256_loadu_si256((const __m256i*)(in_data + (block + 2 * k) * 16));
+
+        // Blocks 0, 2 | 1, 3 and 4, 6 | 5, 7
+        const __m256 color_blocks0123 = _mm256_castsi256_ps(_mm256_unpackhi_epi64(blocks[0], blocks[1]));
+        const __m256 color_blocks4567 = _mm256_castsi256_ps(_mm256_unpackhi_epi64(blocks[2], blocks[3]));
+
+        const __m256i colors = _mm256_castps_si256(_mm256_shuffle_ps(color_blocks0123, color_blocks4567, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m256i bits   = _mm256_castps_si256(_mm256_shuffle_ps(color_blocks0123, color_blocks4567, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        __m256i palettes[4];
+        dxt135_decode_palettes_avx2(colors, false, palettes);
+
+        for (u32 k = 0; k < 4; k++)
+        {
+            __m256i rows[4];
+            dxt135_lookup_texels_avx2(palettes[k], bits, k, rows);
+            insert_alphas_avx2(rows, is_dxt5 ? dxt5_decode_alphablocks_avx2(blocks[k], false)
+                                             : dxt3_decode_alphablocks_avx2(blocks[k]));
+            store_rows_avx2(out_data + (block + 2 * k) * 16, out_pitch, rows);
         }
     }
+
+    bc23_decode_blocks_sse41(in_data + block * 16, out_data + block * 16, out_pitch, num_blocks - block, is_dxt5);
 }
 
-void BCn_DecompressBC5U(u32 width, u32 height, const u8* in_data, u8* out_data)
+static CPU_FEATURES_TARGET_AVX2 void bc2_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
 {
-    u32 pitch = (width + 3) >> 2;
+    bc23_decode_blocks_avx2(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+static CPU_FEATURES_TARGET_AVX2 void bc3_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc23_decode_blocks_avx2(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 void bc4_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_signed)
+{
+    u32 block = 0;
+
+    for (; block + 2 <= num_blocks; block += 2)
+    {
+        // Block 0 | block 1
+        const __m256i blocks = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(in_data + block * 8))),
+                                                        _MM_SHUFFLE(1, 1, 0, 0));
+        const __m256i reds = dxt5_decode_alphablocks_avx2(blocks, is_signed);
 
-    for (u32 y = 0; y < height; y++)
+        __m256i rows[4];
+        for (u32 j = 0; j < 4; j++)
+            rows[j] = _mm256_or_si256(_mm256_shuffle_epi8(reds, _mm256_add_epi8(_mm256_set1_epi8((char)(4 * j)),
+                                                                                BCN_BROADCAST128(_mm_setr_epi8(0, 0, 0, -128, 1, 1, 1, -128, 2, 2, 2, -128, 3, 3, 3, -128)))),
+                                      _mm256_set1_epi32((int)0xFF000000));
+
+        store_rows_avx2(out_data + block * 16, out_pitch, rows);
+    }
+
+    bc4_decode_blocks_sse41(in_data + block * 8, out_data + block * 16, out_pitch, num_blocks - block, is_signed);
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 void bc5_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_signed)
+{
+    u32 block = 0;
+
+    for (; block + 2 <= num_blocks; block += 2)
     {
-        for (u32 x = 0; x < width; x++)
+        // Red | green of each block
+        const __m256i channels0 = dxt5_decode_alphablocks_avx2(_mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(in_data + block * 16))),
+                                                                                        _MM_SHUFFLE(1, 1, 0, 0)), is_signed);
+        const __m256i channels1 = dxt5_decode_alphablocks_avx2(_mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(in_data + block * 16 + 16))),
+                                                                                        _MM_SHUFFLE(1, 1, 0, 0)), is_signed);
+
+        // Block 0 | block 1
+        const __m256i reds   = _mm256_permute2x128_si256(channels0, channels1, 0x20);
+        const __m256i greens = _mm256_permute2x128_si256(channels0, channels1, 0x31);
+
+        const __m256i rg_lo = _mm256_unpacklo_epi8(reds, greens);
+        const __m256i rg_hi = _mm256_unpackhi_epi8(reds, greens);
+        const __m256i ba = _mm256_set1_epi16((short)0xFF00);
+
+        __m256i rows[4];
+        rows[0] = _mm256_unpacklo_epi16(rg_lo, ba);
+        rows[1] = _mm256_unpackhi_epi16(rg_lo, ba);
+        rows[2] = _mm256_unpacklo_epi16(rg_hi, ba);
+        rows[3] = _mm256_unpackhi_epi16(rg_hi, ba);
+
+        store_rows_avx2(out_data + block * 16, out_pitch, rows);
+    }
+
+    bc5_decode_blocks_sse41(in_data + block * 16, out_data + block * 16, out_pitch, num_blocks - block, is_signed);
+}
+
+static CPU_FEATURES_TARGET_AVX2 void bc4s_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc4_decode_blocks_avx2(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+static CPU_FEATURES_TARGET_AVX2 void bc4u_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc4_decode_blocks_avx2(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+static CPU_FEATURES_TARGET_AVX2 void bc5s_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc5_decode_blocks_avx2(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+static CPU_FEATURES_TARGET_AVX2 void bc5u_decode_blocks_avx2(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc5_decode_blocks_avx2(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+#elif defined(BCN_DECODE_KERNELS_NEON)
+
+static inline uint8x16_t dxt135_interpolate_neon(uint16x8_t x, uint32x4_t gt, bool is_dxt1)
+{
+    const uint16x8_t xs = vrev32q_u16(x);
+
+    // (2 * x0 + x1) / 3, (x0 + 2 * x1) / 3
+    const uint16x8_t sums = vaddq_u16(vaddq_u16(x, x), xs);
+    const uint16x8_t thirds = vshrq_n_u16(vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(sums), 0xAAAB), 16),
+                                                       vshrn_n_u32(vmull_high_n_u16(sums, 0xAAAB), 16)), 1);
+
+    // (x0 + x1) / 2, then 0 (punch-through) or (x0 + 2 * x1) / 3
+    const uint16x8_t halves = vhaddq_u16(x, xs);
+    const uint16x8_t others = is_dxt1 ? vandq_u16(halves, vreinterpretq_u16_u32(vdupq_n_u32(0xFFFF)))
+                                      : vbslq_u16(vreinterpretq_u16_u32(vdupq_n_u32(0xFFFF)), halves, thirds);
+
+    const uint16x8_t entries23 = vbslq_u16(vreinterpretq_u16_u32(gt), thirds, others);
+
+    static const u8 entry_order[16] = { 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15 };
+    return vqtbl1q_u8(vcombine_u8(vqmovn_u16(x), vqmovn_u16(entries23)), vld1q_u8(entry_order));
+}
+
+static inline void dxt135_decode_palettes_neon(uint32x4_t colors, bool is_dxt1, uint8x16_t palettes[4])
+{
+    const uint16x8_t c = vreinterpretq_u16_u32(colors);
+
+    const uint16x8_t r = vorrq_u16(vandq_u16(vshrq_n_u16(c,  8), vdupq_n_u16(0xF8)),
+                                             vshrq_n_u16(c, 13));
+    const uint16x8_t g = vorrq_u16(vandq_u16(vshrq_n_u16(c,  3), vdupq_n_u16(0xFC)),
+                                   vandq_u16(vshrq_n_u16(c,  9), vdupq_n_u16(0x03)));
+    const uint16x8_t b = vorrq_u16(vandq_u16(vshlq_n_u16(c,  3), vdupq_n_u16(0xF8)),
+                                   vandq_u16(vshrq_n_u16(c,  2), vdupq_n_u16(0x07)));
+
+    // color0 > color1
+    const uint32x4_t gt = vcgtq_u32(vandq_u32(colors, vdupq_n_u32(0xFFFF)), vshrq_n_u32(colors, 16));
+
+    const uint8x16_t r_entries = dxt135_interpolate_neon(r, gt, is_dxt1);
+    const uint8x16_t g_entries = dxt135_interpolate_neon(g, gt, is_dxt1);
+    const uint8x16_t b_entries = dxt135_interpolate_neon(b, gt, is_dxt1);
+    const uint8x16_t a_entries = is_dxt1 ? vreinterpretq_u8_u32(vorrq_u32(vdupq_n_u32(0x00FFFFFF), vandq_u32(gt, vdupq_n_u32(0xFF000000))))
+                                         : vdupq_n_u8(0);
+
+    const uint16x8_t rg_lo = vreinterpretq_u16_u8(vzip1q_u8(r_entries, g_entries));
+    const uint16x8_t rg_hi = vreinterpretq_u16_u8(vzip2q_u8(r_entries, g_entries));
+    const uint16x8_t ba_lo = vreinterpretq_u16_u8(vzip1q_u8(b_entries, a_entries));
+    const uint16x8_t ba_hi = vreinterpretq_u16_u8(vzip2q_u8(b_entries, a_entries));
+
+    palettes[0] = vreinterpretq_u8_u16(vzip1q_u16(rg_lo, ba_lo));
+    palettes[1] = vreinterpretq_u8_u16(vzip2q_u16(rg_lo, ba_lo));
+    palettes[2] = vreinterpretq_u8_u16(vzip1q_u16(rg_hi, ba_hi));
+    palettes[3] = vreinterpretq_u8_u16(vzip2q_u16(rg_hi, ba_hi));
+}
+
+static inline void dxt135_lookup_texels_neon(uint8x16_t palette, uint8x16_t bits, u32 k, uint8x16_t rows[4])
+{
+    static const u8 row_order[16] = { 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3 };
+    static const s8 index_shifts[16] = { 0, -2, -4, -6, 0, -2, -4, -6, 0, -2, -4, -6, 0, -2, -4, -6 };
+    static const u8 byte_order[16] = { 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3 };
+
+    const uint8x16_t order = vld1q_u8(row_order);
+
+    // Byte 4 * j + i: row j of indices, then index of texel (i, j)
+    const uint8x16_t row_bits = vqtbl1q_u8(bits, vaddq_u8(vdupq_n_u8((u8)(4 * k)), order));
+    const uint8x16_t indices = vandq_u8(vshlq_u8(row_bits, vld1q_s8(index_shifts)), vdupq_n_u8(3));
+    const uint8x16_t offsets = vshlq_n_u8(indices, 2);
+
+    for (u32 j = 0; j < 4; j++)
+    {
+        const uint8x16_t texel_offsets = vqtbl1q_u8(offsets, vaddq_u8(vdupq_n_u8((u8)(4 * j)), order));
+        rows[j] = vqtbl1q_u8(palette, vaddq_u8(texel_offsets, vld1q_u8(byte_order)));
+    }
+}
+
+static inline uint8x16_t dxt3_decode_alphablock_neon(const u8* alpha_block_src)
+{
+    const uint8x8_t bytes = vld1_u8(alpha_block_src);
+    const uint8x8x2_t nibbles = vzip_u8(vand_u8(bytes, vdup_n_u8(0x0F)), vshr_n_u8(bytes, 4));
+
+    return vmulq_u8(vcombine_u8(nibbles.val[0], nibbles.val[1]), vdupq_n_u8(17));
+}
+
+static inline uint16x8_t dxt5_divide_neon(int16x8_t sums, u16 magic, bool is_signed)
+{
+    const uint16x8_t abs_sums = vreinterpretq_u16_s16(is_signed ? vabsq_s16(sums) : sums);
+
+    const uint16x8_t quotients = vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(abs_sums), magic), 16),
+                                              vshrn_n_u32(vmull_high_n_u16(abs_sums, magic), 16));
+    if (!is_signed)
+        return quotients;
+
+    const int16x8_t signed_quotients = vreinterpretq_s16_u16(quotients);
+    return vreinterpretq_u16_s16(vaddq_s16(vbslq_s16(vcltzq_s16(sums), vnegq_s16(signed_quotients), signed_quotients),
+                                           vdupq_n_s16(128)));
+}
+
+static inline uint8x16_t dxt5_decode_alphablock_neon(const u8* alpha_block_src, bool is_signed)
+{
+    static const s16 weights0_7[8] = { 7, 0, 6, 5, 4, 3, 2, 1 };
+    static const s16 weights1_7[8] = { 0, 7, 1, 2, 3, 4, 5, 6 };
+    static const s16 weights0_5[8] = { 5, 0, 4, 3, 2, 1, 0, 0 };
+    static const s16 weights1_5[8] = { 0, 5, 1, 2, 3, 4, 0, 0 };
+    static const u16 extremes_5[8] = { 0, 0, 0, 0, 0, 0, 0, 255 };
+    static const u16 extremes_mask_5[8] = { 0, 0, 0, 0, 0, 0, 0xFFFF, 0xFFFF };
+
+    const s16 alpha0 = is_signed ? (s16)(s8)alpha_block_src[0] : (s16)alpha_block_src[0];
+    const s16 alpha1 = is_signed ? (s16)(s8)alpha_block_src[1] : (s16)alpha_block_src[1];
+
+    const int16x8_t sums7 = vmlaq_n_s16(vmulq_n_s16(vld1q_s16(weights0_7), alpha0), vld1q_s16(weights1_7), alpha1);
+    const int16x8_t sums5 = vmlaq_n_s16(vmulq_n_s16(vld1q_s16(weights0_5), alpha0), vld1q_s16(weights1_5), alpha1);
+
+    const uint16x8_t sevenths = dxt5_divide_neon(sums7, 0x2493, is_signed);
+    const uint16x8_t fifths = vbslq_u16(vld1q_u16(extremes_mask_5), vld1q_u16(extremes_5),
+                                        dxt5_divide_neon(sums5, 0x3334, is_signed));
+
+    const uint8x8_t palette = vmovn_u16(alpha0 > alpha1 ? sevenths : fifths);
+
+    // Code of texel k: 2 bytes holding bits 3k to 3k + 2 of the codes
+    static const u8 code_bytes_lo[16] = { 2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5 };
+    static const u8 code_bytes_hi[16] = { 5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, 8, 7, 8 };
+    static const s16 code_shifts[8] = { 0, -3, -6, -1, -4, -7, -2, -5 };
+
+    // Only the 8 bytes of the block are read: byte 8 (the high byte of the
+    // last code) only holds bits that are masked off
+    const uint8x16_t block = vcombine_u8(vld1_u8(alpha_block_src), vdup_n_u8(0));
+    const int16x8_t shifts = vld1q_s16(code_shifts);
+
+    const uint16x8_t codes_lo = vandq_u16(vshlq_u16(vreinterpretq_u16_u8(vqtbl1q_u8(block, vld1q_u8(code_bytes_lo))), shifts), vdupq_n_u16(7));
+    const uint16x8_t codes_hi = vandq_u16(vshlq_u16(vreinterpretq_u16_u8(vqtbl1q_u8(block, vld1q_u8(code_bytes_hi))), shifts), vdupq_n_u16(7));
+
+    return vqtbl1q_u8(vcombine_u8(palette, palette), vcombine_u8(vmovn_u16(codes_lo), vmovn_u16(codes_hi)));
+}
+
+static inline void insert_alphas_neon(uint8x16_t rows[4], uint8x16_t alphas)
+{
+    static const u8 alpha_order[16] = { 0xFF, 0xFF, 0xFF, 0, 0xFF, 0xFF, 0xFF, 1, 0xFF, 0xFF, 0xFF, 2, 0xFF, 0xFF, 0xFF, 3 };
+
+    for (u32 j = 0; j < 4; j++)
+        rows[j] = vorrq_u8(rows[j], vqtbl1q_u8(alphas, vaddq_u8(vreinterpretq_u8_u32(vdupq_n_u32(0x01000000 * 4 * j)),
+                                                                vld1q_u8(alpha_order))));
+}
+
+static inline void store_rows_neon(u8* out_data, u32 out_pitch, const uint8x16_t rows[4])
+{
+    for (u32 j = 0; j < 4; j++)
+        vst1q_u8(out_data + j * out_pitch, rows[j]);
+}
+
+static void bc1_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    u32 block = 0;
+
+    for (; block + 4 <= num_blocks; block += 4)
+    {
+        const uint32x4_t blocks01 = vreinterpretq_u32_u8(vld1q_u8(in_data + block * 8));
+        const uint32x4_t blocks23 = vreinterpretq_u32_u8(vld1q_u8(in_data + block * 8 + 16));
+
+        const uint32x4_t colors = vuzp1q_u32(blocks01, blocks23);
+        const uint8x16_t bits = vreinterpretq_u8_u32(vuzp2q_u32(blocks01, blocks23));
+
+        uint8x16_t palettes[4];
+        dxt135_decode_palettes_neon(colors, true, palettes);
+
+        for (u32 k = 0; k < 4; k++)
         {
-            u16 RG = fetch_2d_texel_rg_bc5(in_data, x, y, pitch);
+            uint8x16_t rows[4];
+            dxt135_lookup_texels_neon(palettes[k], bits, k, rows);
+            store_rows_neon(out_data + (block + k) * 16, out_pitch, rows);
+        }
+    }
 
-            out_data[RCOMP] = ((u8*)&RG)[RCOMP];
-            out_data[GCOMP] = ((u8*)&RG)[GCOMP];
-            out_data[BCOMP] = 0;
-            out_data[ACOMP] = 255;
-            out_data += 4;
+    bc1_decode_blocks_generic(in_data + block * 8, out_data + block * 16, out_pitch, num_blocks - block);
+}
+
+static inline void bc23_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_dxt5)
+{
+    u32 block = 0;
+
+    for (; block + 4 <= num_blocks; block += 4)
+    {
+        const u8* blocks = in_data + block * 16;
+
+        const uint32x4_t color_blocks01 = vreinterpretq_u32_u8(vcombine_u8(vld1_u8(blocks +  8), vld1_u8(blocks + 24)));
+        const uint32x4_t color_blocks23 = vreinterpretq_u32_u8(vcombine_u8(vld1_u8(blocks + 40), vld1_u8(blocks + 56)));
+
+        const uint32x4_t colors = vuzp1q_u32(color_blocks01, color_blocks23);
+        const uint8x16_t bits = vreinterpretq_u8_u32(vuzp2q_u32(color_blocks01, color_blocks23));
+
+        uint8x16_t palettes[4];
+        dxt135_decode_palettes_neon(colors, false, palettes);
+
+        for (u32 k = 0; k < 4; k++)
+        {
+            uint8x16_t rows[4];
+            dxt135_lookup_texels_neon(palettes[k], bits, k, rows);
+            insert_alphas_neon(rows, is_dxt5 ? dxt5_decode_alphablock_neon(blocks + k * 16, false)
+                                             : dxt3_decode_alphablock_neon(blocks + k * 16));
+            store_rows_neon(out_data + (block + k) * 16, out_pitch, rows);
         }
     }
+
+    if (is_dxt5)
+        bc3_decode_blocks_generic(in_data + block * 16, out_data + block * 16, out_pitch, num_blocks - block);
+    else
+        bc2_decode_blocks_generic(in_data + block * 16, out_data + block * 16, out_pitch, num_blocks - block);
+}
+
+static void bc2_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc23_decode_blocks_neon(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+static void bc3_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc23_decode_blocks_neon(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+static inline void bc4_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_signed)
+{
+    static const u8 red_order[16] = { 0, 0, 0, 0xFF, 1, 1, 1, 0xFF, 2, 2, 2, 0xFF, 3, 3, 3, 0xFF };
+
+    const uint8x16_t order = vld1q_u8(red_order);
+    const uint8x16_t alphas = vreinterpretq_u8_u32(vdupq_n_u32(0xFF000000));
+
+    for (u32 block = 0; block < num_blocks; block++)
+    {
+        const uint8x16_t reds = dxt5_decode_alphablock_neon(in_data + block * 8, is_signed);
+
+        uint8x16_t rows[4];
+        for (u32 j = 0; j < 4; j++)
+            rows[j] = vorrq_u8(vqtbl1q_u8(reds, vaddq_u8(vdupq_n_u8((u8)(4 * j)), order)), alphas);
+
+        store_rows_neon(out_data + block * 16, out_pitch, rows);
+    }
+}
+
+static inline void bc5_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks, bool is_signed)
+{
+    const uint16x8_t ba = vdupq_n_u16(0xFF00);
+
+    for (u32 block = 0; block < num_blocks; block++)
+    {
+        const uint8x16_t reds   = dxt5_decode_alphablock_neon(in_data + block * 16,     is_signed);
+        const uint8x16_t greens = dxt5_decode_alphablock_neon(in_data + block * 16 + 8, is_signed);
+
+        const uint16x8_t rg_lo = vreinterpretq_u16_u8(vzip1q_u8(reds, greens));
+        const uint16x8_t rg_hi = vreinterpretq_u16_u8(vzip2q_u8(reds, greens));
+
+        uint8x16_t rows[4];
+        rows[0] = vreinterpretq_u8_u16(vzip1q_u16(rg_lo, ba));
+        rows[1] = vreinterpretq_u8_u16(vzip2q_u16(rg_lo, ba));
+        rows[2] = vreinterpretq_u8_u16(vzip1q_u16(rg_hi, ba));
+        rows[3] = vreinterpretq_u8_u16(vzip2q_u16(rg_hi, ba));
+
+        store_rows_neon(out_data + block * 16, out_pitch, rows);
+    }
+}
+
+static void bc4s_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc4_decode_blocks_neon(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+static void bc4u_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc4_decode_blocks_neon(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+static void bc5s_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc5_decode_blocks_neon(in_data, out_data, out_pitch, num_blocks, true);
+}
+
+static void bc5u_decode_blocks_neon(const u8* in_data, u8* out_data, u32 out_pitch, u32 num_blocks)
+{
+    bc5_decode_blocks_neon(in_data, out_data, out_pitch, num_blocks, false);
+}
+
+#endif
+
+// Kernels of a format available in this build, best first
+#if defined(BCN_DECODE_KERNELS_X86)
+    #define BCN_DECODE_BLOCKS_KERNELS(format) format##_decode_blocks_avx2, format##_decode_blocks_sse41, NULL, format##_decode_blocks_generic
+#elif defined(BCN_DECODE_KERNELS_NEON)
+    #define BCN_DECODE_BLOCKS_KERNELS(format) NULL, NULL, format##_decode_blocks_neon, format##_decode_blocks_generic
+#else
+    #define BCN_DECODE_BLOCKS_KERNELS(format) NULL, NULL, NULL, format##_decode_blocks_generic
+#endif
+
+static BCnDecodeBlocksFunc select_decode_blocks(BCnDecodeBlocksFunc avx2, BCnDecodeBlocksFunc sse41,
+                                                BCnDecodeBlocksFunc neon, BCnDecodeBlocksFunc generic)
+{
+    const u32 features = CPUFeatures_Get();
+
+    if (avx2 && (features & CPU_FEATURE_AVX2))
+        return avx2;
+
+    if (sse41 && (features & CPU_FEATURE_SSE41))
+        return sse41;
+
+    if (neon && (features & CPU_FEATURE_NEON))
+        return neon;
+
+    return generic;
+}
+
+typedef struct
+{
+    u32 block_size;
+    BCnDecodeBlocksFunc decode_blocks;
+    BCnDecodeBlockFunc decode_block;
+} BCnDecoder;
+
+static inline BCnDecoder make_decoder(u32 block_size, BCnDecodeBlocksFunc decode_blocks, BCnDecodeBlockFunc decode_block)
+{
+    BCnDecoder decoder;
+    decoder.block_size = block_size;
+    decoder.decode_blocks = decode_blocks;
+    decoder.decode_block = decode_block;
+    return decoder;
+}
+
+static BCnDecoder select_decoder(BCnFormat format)
+{
+    switch (format)
+    {
+    case BCN_FORMAT_BC1:  return make_decoder( 8, select_decode_blocks(BCN_DECODE_BLOCKS_KERNELS(bc1)),  bc1_decode_block);
+    case BCN_FORMAT_BC2:  return make_decoder(16, select_decode_blocks(BCN_DECODE_BLOCKS_KERNELS(bc2)),  bc2_decode_block);
+    case BCN_FORMAT_BC3:  return make_decoder(16, select_decode_blocks(BCN_DECODE_BLOCKS_KERNELS(bc3)),  bc3_decode_block);
+    case BCN_FORMAT_BC4U: return make_decoder( 8, select_decode_blocks(BCN_DECODE_BLOCKS_KERNELS(bc4u)), bc4u_decode_block);
+    case BCN_FORMAT_BC4S: return make_decoder( 8, select_decode_blocks(BCN_DECODE_BLOCKS_KERNELS(bc4s)), bc4s_decode_block);
+    case BCN_FORMAT_BC5U: return make_decoder(16, select_decode_blocks(BCN_DECODE_BLOCKS_KERNELS(bc5u)), bc5u_decode_block);
+    case BCN_FORMAT_BC5S: return make_decoder(16, select_decode_blocks(BCN_DECODE_BLOCKS_KERNELS(bc5s)), bc5s_decode_block);
+    }
+
+    assert(false);
+    return make_decoder(8, bc1_decode_blocks_generic, bc1_decode_block);
+}
+
+// Decodes the top-left width x height texels (height <= 4) of a row of
+// blocks. Full blocks go through decode_blocks, blocks crossing the right
+// or bottom edge of the image through decode_block.
+static void decompress_rgba_block_row(u32 width, u32 height, const u8* in_data, u8* out_data, u32 out_pitch,
+                                      const BCnDecoder* decoder)
+{
+    u8 pixels[16][4];
+    u32 x = 0;
+
+    if (height == 4)
+    {
+        const u32 num_blocks = width / 4;
+        decoder->decode_blocks(in_data, out_data, out_pitch, num_blocks);
+
+        in_data += num_blocks * decoder->block_size;
+        x = num_blocks * 4;
+    }
+
+    for (; x < width; x += 4)
+    {
+        decoder->decode_block(in_data, pixels);
+        store_block_rgba(pixels[0], out_data + x * 4, out_pitch, width - x < 4 ? width - x : 4, height);
+        in_data += decoder->block_size;
+    }
+}
+
+// Decodes block rows [row_begin, row_end) of the image
+static void decompress_rgba_rows(u32 width, u32 height, const u8* in_data, u8* out_data, const BCnDecoder* decoder,
+                                 u32 row_begin, u32 row_end)
+{
+    const u32 out_pitch = width * 4;
+    const size_t in_row_size = (size_t)((width + 3) / 4) * decoder->block_size;
+
+    for (u32 row = row_begin; row < row_end; row++)
+    {
+        const u32 y = row * 4;
+        decompress_rgba_block_row(width, height - y < 4 ? height - y : 4, in_data + row * in_row_size,
+                                  out_data + (size_t)y * out_pitch, out_pitch, decoder);
+    }
+}
+
+static void decompress_rgba(u32 width, u32 height, const u8* in_data, u8* out_data, const BCnDecoder* decoder)
+{
+    decompress_rgba_rows(width, height, in_data, out_data, decoder, 0, (height + 3) / 4);
+}
+
+// Images are split into bands of block rows of at least this many bytes of
+// output, so that small images (and mip levels) are decoded by the calling
+// thread alone
+#define BCN_DECOMPRESS_MIN_BAND_SIZE 0x40000
+
+typedef struct
+{
+    u32 width;
+    u32 height;
+    const u8* in_data;
+    u8* out_data;
+    const BCnDecoder* decoder;
+    u32 rows_per_band;
+    u32 num_rows;
+} BCnDecompressJob;
+
+static void decompress_rgba_band(void* user_data, u32 index)
+{
+    const BCnDecompressJob* job = (const BCnDecompressJob*)user_data;
+
+    const u32 row_begin = index * job->rows_per_band;
+    u32 row_end = row_begin + job->rows_per_band;
+    if (row_end > job->num_rows)
+        row_end = job->num_rows;
+
+    decompress_rgba_rows(job->width, job->height, job->in_data, job->out_data, job->decoder, row_begin, row_end);
+}
+
+// Bands write to disjoint rows of the output, so the result does not depend
+// on the number of threads or the order in which bands are decoded
+static void decompress_rgba_parallel(u32 width, u32 height, const u8* in_data, u8* out_data, const BCnDecoder* decoder)
+{
+    const u32 num_rows = (height + 3) / 4;
+    const size_t row_size = (size_t)width * 4 * 4;
+
+    u32 rows_per_band = num_rows;
+    if (row_size * num_rows > BCN_DECOMPRESS_MIN_BAND_SIZE)
+        rows_per_band = (u32)((BCN_DECOMPRESS_MIN_BAND_SIZE + row_size - 1) / row_size);
+
+    if (rows_per_band >= num_rows)
+    {
+        decompress_rgba(width, height, in_data, out_data, decoder);
+        return;
+    }
+
+    BCnDecompressJob job;
+    job.width = width;
+    job.height = height;
+    job.in_data = in_data;
+    job.out_data = out_data;
+    job.decoder = decoder;
+    job.rows_per_band = rows_per_band;
+    job.num_rows = num_rows;
+
+    TexThreadPool_ParallelFor((num_rows + rows_per_band - 1) / rows_per_band, decompress_rgba_band, &job);
+}
+
+void BCn_DecompressBlockRow(BCnFormat format, u32 width, u32 height, const u8* in_data, u8* out_data, u32 out_pitch)
+{
+    const BCnDecoder decoder = select_decoder(format);
+    decompress_rgba_block_row(width, height, in_data, out_data, out_pitch, &decoder);
+}
+
+void BCn_DecompressBC1(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC1);
+    decompress_rgba(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC2(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC2);
+    decompress_rgba(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC3(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC3);
+    decompress_rgba(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC4S(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC4S);
+    decompress_rgba(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC4U(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC4U);
+    decompress_rgba(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC5S(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC5S);
+    decompress_rgba(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC5U(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC5U);
+    decompress_rgba(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC1Parallel(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC1);
+    decompress_rgba_parallel(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC2Parallel(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC2);
+    decompress_rgba_parallel(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC3Parallel(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC3);
+    decompress_rgba_parallel(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC4SParallel(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC4S);
+    decompress_rgba_parallel(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC4UParallel(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC4U);
+    decompress_rgba_parallel(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC5SParallel(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC5S);
+    decompress_rgba_parallel(width, height, in_data, out_data, &decoder);
+}
+
+void BCn_DecompressBC5UParallel(u32 width, u32 height, const u8* in_data, u8* out_data)
+{
+    const BCnDecoder decoder = select_decoder(BCN_FORMAT_BC5U);
+    decompress_rgba_parallel(width, height, in_data, out_data, &decoder);
 }
@@ -0,0 +1,105 @@
+#include <ninTexUtils/cpu_features.h>
+
+#include <atomic>
+
+#if defined(CPU_FEATURES_ARCH_X86)
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+static std::atomic<u32> features_mask(~0u);
+
+#if defined(CPU_FEATURES_ARCH_X86)
+
+static void cpuid(u32 leaf, u32 subleaf, u32* regs)
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, (int)leaf, (int)subleaf);
+    regs[0] = info[0];
+    regs[1] = info[1];
+    regs[2] = info[2];
+    regs[3] = info[3];
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static u64 xgetbv(u32 index)
+{
+#ifdef _MSC_VER
+    return _xgetbv(index);
+#else
+    u32 eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return (u64)edx << 32 | eax;
+#endif
+}
+
+static u32 detect_features(void)
+{
+    u32 features = 0;
+    u32 regs[4];
+
+    cpuid(0, 0, regs);
+    const u32 max_leaf = regs[0];
+    if (max_leaf < 1)
+        return 0;
+
+    cpuid(1, 0, regs);
+    const u32 ecx = regs[2];
+    const u32 edx = regs[3];
+
+    if (edx & (1u << 26)) features |= CPU_FEATURE_SSE2;
+    if (ecx & (1u <<  9)) features |= CPU_FEATURE_SSSE3;
+    if (ecx & (1u << 19)) features |= CPU_FEATURE_SSE41;
+
+    // AVX2 also needs the OS to save the YMM registers
+    const bool osxsave = ecx & (1u << 27);
+    const bool avx = ecx & (1u << 28);
+    if (osxsave && avx && (xgetbv(0) & 6) == 6 && max_leaf >= 7)
+    {
+        cpuid(7, 0, regs);
+        if (regs[1] & (1u << 5))
+            features |= CPU_FEATURE_AVX2;
+    }
+
+    return features;
+}
+
+#elif defined(CPU_FEATURES_ARCH_ARM)
+
+static u32 detect_features(void)
+{
+    // NEON is mandatory on AArch64, and the code paths using it on 32-bit
+    // ARM are only compiled in when the compiler targets it anyway
+    return CPU_FEATURE_NEON;
+}
+
+#else
+
+static u32 detect_features(void)
+{
+    return 0;
+}
+
+#endif
+
+extern "C"
+{
+
+u32 CPUFeatures_Get(void)
+{
+    static const u32 detected_features = detect_features();
+    return detected_features & features_mask.load(std::memory_order_relaxed);
+}
+
+void CPUFeatures_SetMask(u32 mask)
+{
+    features_mask.store(mask, std::memory_order_relaxed);
+}
+
+}
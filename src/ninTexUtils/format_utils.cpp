@@ -0,0 +1,1065 @@
+#include <ninTexUtils/format_utils.h>
+#include <ninTexUtils/cpu_features.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define TEX_FORMAT_UTILS_KERNELS_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define TEX_FORMAT_UTILS_KERNELS_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// Converts the first num_pixels pixels of in_data and returns how many
+// were converted (the SIMD kernels leave a tail of less than one vector's
+// worth for the generic code).
+typedef u32 (*TexFormatUtilsToRGBA8Func)(const u8* in_data, u8* out_data, u32 num_pixels,
+                                         const TexFormatUtilsComponent comp_sel[4]);
+
+// Builds a table of the instantiations of a converter for every format,
+// indexed by TexFormatUtilsFormat
+#define TEX_FORMAT_UTILS_FORMAT_TABLE(ENTRY)   \
+    {                                           \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_L8),      \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_LA8),     \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_LA4),     \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_RGB565),  \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_RGB5A1),  \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_RGBA4),   \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_RGBX8),   \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_RGB10A2), \
+        ENTRY(TEX_FORMAT_UTILS_FORMAT_RGBA8)    \
+    }
+
+#define TEX_FORMAT_UTILS_NUM_FORMATS (TEX_FORMAT_UTILS_FORMAT_RGBA8 + 1)
+
+// Generic converters.
+// The conversion loop is instantiated for each format, so that the format
+// is resolved at compile time, and for whether the component selection is
+// the identity, in which case the expanded pixels are stored as they are.
+// Other selections are applied from shifts and masks computed once per
+// call, without branching on the selectors in the loop.
+
+static inline u32 read_pixel(const u8* in_data, u32 bpp)
+{
+    /* Read pixel data in little endian */
+
+    switch (bpp)
+    {
+    case 1:
+        return in_data[0];
+    case 2:
+        return in_data[0] | in_data[1] << 8;
+    default:
+        return in_data[0] | in_data[1] << 8 | in_data[2] << 16 | (u32)in_data[3] << 24;
+    }
+}
+
+// Expands a pixel to RGBA8, with R in the low byte
+template <TexFormatUtilsFormat format>
+static inline u32 expand_pixel(u32 pixel)
+{
+    u8 comp[6] = { 0, 0, 0, 255 };
+    TexFormatUtils_GetComponentsFromPixel(format, pixel, comp);
+
+    return comp[0] | comp[1] << 8 | comp[2] << 16 | (u32)comp[3] << 24;
+}
+
+template <TexFormatUtilsFormat format, bool identity>
+static u32 to_rgba8_generic(const u8* in_data, u8* out_data, u32 num_pixels,
+                            const TexFormatUtilsComponent comp_sel[4])
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+
+    u32 shift[4], keep[4], ones = 0;
+    for (u32 i = 0; i < 4; i++)
+    {
+        const u32 sel = comp_sel[i];
+        shift[i] = sel < 4 ? sel * 8 : 0;
+        keep[i] = sel < 4 ? 0xFF : 0;
+        ones |= (sel == TEX_FORMAT_UTILS_COMPONENT_1 ? 0xFFu : 0) << (i * 8);
+    }
+
+    for (u32 pixel_idx = 0; pixel_idx < num_pixels; pixel_idx++)
+    {
+        const u32 rgba = expand_pixel<format>(read_pixel(in_data + pixel_idx * bpp, bpp));
+
+        u32 out = rgba;
+        if (!identity)
+            out = ones | (rgba >> shift[0] & keep[0])
+                       | (rgba >> shift[1] & keep[1]) << 8
+                       | (rgba >> shift[2] & keep[2]) << 16
+                       | (rgba >> shift[3] & keep[3]) << 24;
+
+        u8* out_pixel = out_data + pixel_idx * 4;
+        out_pixel[0] = out;
+        out_pixel[1] = out >> 8;
+        out_pixel[2] = out >> 16;
+        out_pixel[3] = out >> 24;
+    }
+
+    return num_pixels;
+}
+
+#define TEX_FORMAT_UTILS_GENERIC_ENTRY(format)          to_rgba8_generic<format, false>
+#define TEX_FORMAT_UTILS_GENERIC_IDENTITY_ENTRY(format) to_rgba8_generic<format, true>
+
+static const TexFormatUtilsToRGBA8Func to_rgba8_generic_table[2][TEX_FORMAT_UTILS_NUM_FORMATS] = {
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_GENERIC_ENTRY),
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_GENERIC_IDENTITY_ENTRY)
+};
+
+// SIMD converters.
+// Pixels are first expanded to RGBA8 (with the same defaults as the
+// generic code for the components a format does not have), then the
+// component selection is applied as a byte shuffle, with the selectors of
+// constant 1 or'ed in afterwards.
+// Expansions of 5-, 6- and 10-bit components are the multiplications by
+// reciprocals of x * 0xFF / 0x1F, 0x3F and 0x3FF that are exact over the
+// range of x, so results are identical to TexFormatUtils_GetComponentsFromPixel:
+//   x * 0xFF / 0x1F  == x * 1053 >> 7  == mulhi(x << 9, 1053)
+//   x * 0xFF / 0x3F  == x * 4145 >> 10 == mulhi(x << 6, 4145)
+//   x * 0xFF / 0x3FF == x * 1021 >> 12 == mulhi(x << 4, 1021)
+// 8- and 16-bit formats are expanded in 16-bit lanes (one pixel per lane)
+// to their RG and BA component pairs, which are then interleaved.
+
+#if defined(TEX_FORMAT_UTILS_KERNELS_X86)
+
+// Byte shuffle control (0x80 for the constant selectors, which zero the
+// byte) and constant 1 mask of a component selection, for one pixel
+static inline void get_selection_masks(const TexFormatUtilsComponent comp_sel[4], u32* shuffle, u32* ones)
+{
+    *shuffle = 0;
+    *ones = 0;
+
+    for (u32 i = 0; i < 4; i++)
+    {
+        const u32 sel = comp_sel[i];
+        *shuffle |= (sel < 4 ? sel : 0x80) << (i * 8);
+        *ones |= (sel == TEX_FORMAT_UTILS_COMPONENT_1 ? 0xFF : 0) << (i * 8);
+    }
+}
+
+static inline CPU_FEATURES_TARGET_SSSE3 __m128i rgb10a2_to_rgba8_ssse3(__m128i p)
+{
+    const __m128i mask = _mm_set1_epi32(0x3FF0);
+    const __m128i magic = _mm_set1_epi16(1021);
+
+    const __m128i r = _mm_mulhi_epu16(_mm_and_si128(_mm_slli_epi32(p,  4), mask), magic);
+    const __m128i g = _mm_mulhi_epu16(_mm_and_si128(_mm_srli_epi32(p,  6), mask), magic);
+    const __m128i b = _mm_mulhi_epu16(_mm_and_si128(_mm_srli_epi32(p, 16), mask), magic);
+    const __m128i a = _mm_mullo_epi16(_mm_srli_epi32(p, 30), _mm_set1_epi16(85));
+
+    return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+}
+
+// Expands 8 pixels to RGBA8
+static inline CPU_FEATURES_TARGET_SSSE3 void expand_pixels_ssse3(const u8* in_data, TexFormatUtilsFormat format, __m128i rgba[2])
+{
+    const __m128i opaque = _mm_set1_epi16((short)0xFF00);
+    const __m128i mask5 = _mm_set1_epi16(0x1F << 9);
+    const __m128i magic5 = _mm_set1_epi16(1053);
+    const __m128i magic6 = _mm_set1_epi16(4145);
+    __m128i p, rg, ba, lo, hi;
+
+    switch (format)
+    {
+    case TEX_FORMAT_UTILS_FORMAT_RGBX8:
+        rgba[0] = _mm_or_si128(_mm_loadu_si128((const __m128i*)in_data),        _mm_set1_epi32((int)0xFF000000));
+        rgba[1] = _mm_or_si128(_mm_loadu_si128((const __m128i*)(in_data + 16)), _mm_set1_epi32((int)0xFF000000));
+        return;
+    case TEX_FORMAT_UTILS_FORMAT_RGB10A2:
+        rgba[0] = rgb10a2_to_rgba8_ssse3(_mm_loadu_si128((const __m128i*)in_data));
+        rgba[1] = rgb10a2_to_rgba8_ssse3(_mm_loadu_si128((const __m128i*)(in_data + 16)));
+        return;
+    case TEX_FORMAT_UTILS_FORMAT_RGBA8:
+        rgba[0] = _mm_loadu_si128((const __m128i*)in_data);
+        rgba[1] = _mm_loadu_si128((const __m128i*)(in_data + 16));
+        return;
+    case TEX_FORMAT_UTILS_FORMAT_L8:
+        rg = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in_data), _mm_setzero_si128());
+        ba = opaque;
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_LA4:
+        p = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in_data), _mm_setzero_si128());
+        p = _mm_and_si128(_mm_or_si128(p, _mm_slli_epi16(p, 4)), _mm_set1_epi16(0x0F0F));
+        rg = _mm_mullo_epi16(p, _mm_set1_epi16(17));
+        ba = opaque;
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_LA8:
+        rg = _mm_loadu_si128((const __m128i*)in_data);
+        ba = opaque;
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGB565:
+        p = _mm_loadu_si128((const __m128i*)in_data);
+        rg = _mm_or_si128(_mm_mulhi_epu16(_mm_and_si128(_mm_slli_epi16(p, 9), mask5), magic5),
+                          _mm_slli_epi16(_mm_mulhi_epu16(_mm_and_si128(_mm_slli_epi16(p, 1), _mm_set1_epi16(0x3F << 6)), magic6), 8));
+        ba = _mm_or_si128(_mm_mulhi_epu16(_mm_and_si128(_mm_srli_epi16(p, 2), mask5), magic5), opaque);
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGB5A1:
+        p = _mm_loadu_si128((const __m128i*)in_data);
+        rg = _mm_or_si128(_mm_mulhi_epu16(_mm_and_si128(_mm_slli_epi16(p, 9), mask5), magic5),
+                          _mm_slli_epi16(_mm_mulhi_epu16(_mm_and_si128(_mm_slli_epi16(p, 4), mask5), magic5), 8));
+        ba = _mm_or_si128(_mm_mulhi_epu16(_mm_and_si128(_mm_srli_epi16(p, 1), mask5), magic5),
+                          _mm_and_si128(_mm_srai_epi16(p, 15), opaque));
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGBA4:
+        p = _mm_loadu_si128((const __m128i*)in_data);
+        lo = _mm_mullo_epi16(_mm_and_si128(p,                    _mm_set1_epi16(0x0F0F)), _mm_set1_epi16(17));
+        hi = _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(p, 4), _mm_set1_epi16(0x0F0F)), _mm_set1_epi16(17));
+        rg = _mm_or_si128(_mm_and_si128(lo, _mm_set1_epi16(0xFF)), _mm_slli_epi16(hi, 8));
+        ba = _mm_or_si128(_mm_srli_epi16(lo, 8), _mm_and_si128(hi, opaque));
+        break;
+    default:
+        rg = ba = _mm_setzero_si128();
+    }
+
+    rgba[0] = _mm_unpacklo_epi16(rg, ba);
+    rgba[1] = _mm_unpackhi_epi16(rg, ba);
+}
+
+template <TexFormatUtilsFormat format>
+static CPU_FEATURES_TARGET_SSSE3 u32 to_rgba8_ssse3(const u8* in_data, u8* out_data, u32 num_pixels,
+                                                    const TexFormatUtilsComponent comp_sel[4])
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+
+    u32 shuffle, ones;
+    get_selection_masks(comp_sel, &shuffle, &ones);
+
+    const __m128i shuffle_v = _mm_add_epi8(_mm_set1_epi32((int)shuffle), _mm_set_epi8(12, 12, 12, 12, 8, 8, 8, 8, 4, 4, 4, 4, 0, 0, 0, 0));
+    const __m128i ones_v = _mm_set1_epi32((int)ones);
+
+    u32 i = 0;
+    for (; i + 8 <= num_pixels; i += 8)
+    {
+        __m128i rgba[2];
+        expand_pixels_ssse3(in_data + i * bpp, format, rgba);
+
+        _mm_storeu_si128((__m128i*)(out_data + i * 4),      _mm_or_si128(_mm_shuffle_epi8(rgba[0], shuffle_v), ones_v));
+        _mm_storeu_si128((__m128i*)(out_data + i * 4 + 16), _mm_or_si128(_mm_shuffle_epi8(rgba[1], shuffle_v), ones_v));
+    }
+
+    return i;
+}
+
+#define TEX_FORMAT_UTILS_SSSE3_ENTRY(format) to_rgba8_ssse3<format>
+
+static const TexFormatUtilsToRGBA8Func to_rgba8_ssse3_table[TEX_FORMAT_UTILS_NUM_FORMATS] =
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_SSSE3_ENTRY);
+
+// AVX2 versions of the above, on 16 pixels.
+// 8- and 16-bit pixels are loaded with their 64-bit quarters in the order
+// 0, 2, 1, 3, so that unpacking the RG and BA pairs within each 128-bit
+// lane yields the pixels in order.
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i rgb10a2_to_rgba8_avx2(__m256i p)
+{
+    const __m256i mask = _mm256_set1_epi32(0x3FF0);
+    const __m256i magic = _mm256_set1_epi16(1021);
+
+    const __m256i r = _mm256_mulhi_epu16(_mm256_and_si256(_mm256_slli_epi32(p,  4), mask), magic);
+    const __m256i g = _mm256_mulhi_epu16(_mm256_and_si256(_mm256_srli_epi32(p,  6), mask), magic);
+    const __m256i b = _mm256_mulhi_epu16(_mm256_and_si256(_mm256_srli_epi32(p, 16), mask), magic);
+    const __m256i a = _mm256_mullo_epi16(_mm256_srli_epi32(p, 30), _mm256_set1_epi16(85));
+
+    return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)), _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i load_pixels8_avx2(const u8* in_data)
+{
+    return _mm256_permute4x64_epi64(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)in_data)), 0xD8);
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i load_pixels16_avx2(const u8* in_data)
+{
+    return _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)in_data), 0xD8);
+}
+
+// Expands 16 pixels to RGBA8
+static inline CPU_FEATURES_TARGET_AVX2 void expand_pixels_avx2(const u8* in_data, TexFormatUtilsFormat format, __m256i rgba[2])
+{
+    const __m256i opaque = _mm256_set1_epi16((short)0xFF00);
+    const __m256i mask5 = _mm256_set1_epi16(0x1F << 9);
+    const __m256i magic5 = _mm256_set1_epi16(1053);
+    const __m256i magic6 = _mm256_set1_epi16(4145);
+    __m256i p, rg, ba, lo, hi;
+
+    switch (format)
+    {
+    case TEX_FORMAT_UTILS_FORMAT_RGBX8:
+        rgba[0] = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)in_data),        _mm256_set1_epi32((int)0xFF000000));
+        rgba[1] = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(in_data + 32)), _mm256_set1_epi32((int)0xFF000000));
+        return;
+    case TEX_FORMAT_UTILS_FORMAT_RGB10A2:
+        rgba[0] = rgb10a2_to_rgba8_avx2(_mm256_loadu_si256((const __m256i*)in_data));
+        rgba[1] = rgb10a2_to_rgba8_avx2(_mm256_loadu_si256((const __m256i*)(in_data + 32)));
+        return;
+    case TEX_FORMAT_UTILS_FORMAT_RGBA8:
+        rgba[0] = _mm256_loadu_si256((const __m256i*)in_data);
+        rgba[1] = _mm256_loadu_si256((const __m256i*)(in_data + 32));
+        return;
+    case TEX_FORMAT_UTILS_FORMAT_L8:
+        rg = load_pixels8_avx2(in_data);
+        ba = opaque;
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_LA4:
+        p = load_pixels8_avx2(in_data);
+        p = _mm256_and_si256(_mm256_or_si256(p, _mm256_slli_epi16(p, 4)), _mm256_set1_epi16(0x0F0F));
+        rg = _mm256_mullo_epi16(p, _mm256_set1_epi16(17));
+        ba = opaque;
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_LA8:
+        rg = load_pixels16_avx2(in_data);
+        ba = opaque;
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGB565:
+        p = load_pixels16_avx2(in_data);
+        rg = _mm256_or_si256(_mm256_mulhi_epu16(_mm256_and_si256(_mm256_slli_epi16(p, 9), mask5), magic5),
+                             _mm256_slli_epi16(_mm256_mulhi_epu16(_mm256_and_si256(_mm256_slli_epi16(p, 1), _mm256_set1_epi16(0x3F << 6)), magic6), 8));
+        ba = _mm256_or_si256(_mm256_mulhi_epu16(_mm256_and_si256(_mm256_srli_epi16(p, 2), mask5), magic5), opaque);
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGB5A1:
+        p = load_pixels16_avx2(in_data);
+        rg = _mm256_or_si256(_mm256_mulhi_epu16(_mm256_and_si256(_mm256_slli_epi16(p, 9), mask5), magic5),
+                             _mm256_slli_epi16(_mm256_mulhi_epu16(_mm256_and_si256(_mm256_slli_epi16(p, 4), mask5), magic5), 8));
+        ba = _mm256_or_si256(_mm256_mulhi_epu16(_mm256_and_si256(_mm256_srli_epi16(p, 1), mask5), magic5),
+                             _mm256_and_si256(_mm256_srai_epi16(p, 15), opaque));
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGBA4:
+        p = load_pixels16_avx2(in_data);
+        lo = _mm256_mullo_epi16(_mm256_and_si256(p,                       _mm256_set1_epi16(0x0F0F)), _mm256_set1_epi16(17));
+        hi = _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi16(p, 4), _mm256_set1_epi16(0x0F0F)), _mm256_set1_epi16(17));
+        rg = _mm256_or_si256(_mm256_and_si256(lo, _mm256_set1_epi16(0xFF)), _mm256_slli_epi16(hi, 8));
+        ba = _mm256_or_si256(_mm256_srli_epi16(lo, 8), _mm256_and_si256(hi, opaque));
+        break;
+    default:
+        rg = ba = _mm256_setzero_si256();
+    }
+
+    rgba[0] = _mm256_unpacklo_epi16(rg, ba);
+    rgba[1] = _mm256_unpackhi_epi16(rg, ba);
+}
+
+template <TexFormatUtilsFormat format>
+static CPU_FEATURES_TARGET_AVX2 u32 to_rgba8_avx2(const u8* in_data, u8* out_data, u32 num_pixels,
+                                                  const TexFormatUtilsComponent comp_sel[4])
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+
+    u32 shuffle, ones;
+    get_selection_masks(comp_sel, &shuffle, &ones);
+
+    const __m256i shuffle_v = _mm256_add_epi8(_mm256_set1_epi32((int)shuffle),
+                                              _mm256_broadcastsi128_si256(_mm_set_epi8(12, 12, 12, 12, 8, 8, 8, 8, 4, 4, 4, 4, 0, 0, 0, 0)));
+    const __m256i ones_v = _mm256_set1_epi32((int)ones);
+
+    u32 i = 0;
+    for (; i + 16 <= num_pixels; i += 16)
+    {
+        __m256i rgba[2];
+        expand_pixels_avx2(in_data + i * bpp, format, rgba);
+
+        _mm256_storeu_si256((__m256i*)(out_data + i * 4),      _mm256_or_si256(_mm256_shuffle_epi8(rgba[0], shuffle_v), ones_v));
+        _mm256_storeu_si256((__m256i*)(out_data + i * 4 + 32), _mm256_or_si256(_mm256_shuffle_epi8(rgba[1], shuffle_v), ones_v));
+    }
+
+    return i;
+}
+
+#define TEX_FORMAT_UTILS_AVX2_ENTRY(format) to_rgba8_avx2<format>
+
+static const TexFormatUtilsToRGBA8Func to_rgba8_avx2_table[TEX_FORMAT_UTILS_NUM_FORMATS] =
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_AVX2_ENTRY);
+
+#elif defined(TEX_FORMAT_UTILS_KERNELS_NEON)
+
+// NEON versions, on 16 pixels expanded to one vector per component.
+// The component selection picks the vectors given to the interleaving
+// store, which is the NEON equivalent of the byte shuffle.
+
+static inline uint8x16_t narrow_u16_neon(uint16x8_t lo, uint16x8_t hi)
+{
+    return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+}
+
+static inline uint8x16_t narrow_u32_neon(const uint32x4_t v[4])
+{
+    return narrow_u16_neon(vcombine_u16(vmovn_u32(v[0]), vmovn_u32(v[1])),
+                           vcombine_u16(vmovn_u32(v[2]), vmovn_u32(v[3])));
+}
+
+static inline uint16x8_t unorm5_to_8_neon(uint16x8_t x)
+{
+    return vshrq_n_u16(vmulq_n_u16(x, 1053), 7);
+}
+
+static inline uint16x8_t unorm6_to_8_neon(uint16x8_t x)
+{
+    return vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(x),  4145), 10),
+                        vshrn_n_u32(vmull_n_u16(vget_high_u16(x), 4145), 10));
+}
+
+static inline uint32x4_t unorm10_to_8_neon(uint32x4_t x)
+{
+    return vshrq_n_u32(vmulq_n_u32(x, 1021), 12);
+}
+
+static inline uint8x16_t unorm4_to_8_neon(uint8x16_t x)
+{
+    return vmulq_u8(x, vdupq_n_u8(17));
+}
+
+// Expands 16 pixels to the vectors of their R, G, B and A components
+static inline void expand_pixels_neon(const u8* in_data, TexFormatUtilsFormat format, uint8x16_t comp[4])
+{
+    uint8x16x2_t p8x2;
+    uint8x16x4_t p8x4;
+    uint16x8_t p16[2], c16[2][4];
+    uint32x4_t p32, c32[4][4];
+
+    comp[1] = comp[2] = vdupq_n_u8(0);
+    comp[3] = vdupq_n_u8(0xFF);
+
+    switch (format)
+    {
+    case TEX_FORMAT_UTILS_FORMAT_L8:
+        comp[0] = vld1q_u8(in_data);
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_LA4:
+        comp[0] = vld1q_u8(in_data);
+        comp[1] = unorm4_to_8_neon(vshrq_n_u8(comp[0], 4));
+        comp[0] = unorm4_to_8_neon(vandq_u8(comp[0], vdupq_n_u8(0xF)));
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_LA8:
+        p8x2 = vld2q_u8(in_data);
+        comp[0] = p8x2.val[0];
+        comp[1] = p8x2.val[1];
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGBA4:
+        p8x2 = vld2q_u8(in_data);
+        comp[0] = unorm4_to_8_neon(vandq_u8(p8x2.val[0], vdupq_n_u8(0xF)));
+        comp[1] = unorm4_to_8_neon(vshrq_n_u8(p8x2.val[0], 4));
+        comp[2] = unorm4_to_8_neon(vandq_u8(p8x2.val[1], vdupq_n_u8(0xF)));
+        comp[3] = unorm4_to_8_neon(vshrq_n_u8(p8x2.val[1], 4));
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGB565:
+        for (u32 i = 0; i < 2; i++)
+        {
+            p16[i] = vld1q_u16((const u16*)(in_data + i * 16));
+            c16[i][0] = unorm5_to_8_neon(vandq_u16(p16[i], vdupq_n_u16(0x1F)));
+            c16[i][1] = unorm6_to_8_neon(vandq_u16(vshrq_n_u16(p16[i], 5), vdupq_n_u16(0x3F)));
+            c16[i][2] = unorm5_to_8_neon(vshrq_n_u16(p16[i], 11));
+        }
+        for (u32 j = 0; j < 3; j++)
+            comp[j] = narrow_u16_neon(c16[0][j], c16[1][j]);
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGB5A1:
+        for (u32 i = 0; i < 2; i++)
+        {
+            p16[i] = vld1q_u16((const u16*)(in_data + i * 16));
+            c16[i][0] = unorm5_to_8_neon(vandq_u16(p16[i], vdupq_n_u16(0x1F)));
+            c16[i][1] = unorm5_to_8_neon(vandq_u16(vshrq_n_u16(p16[i],  5), vdupq_n_u16(0x1F)));
+            c16[i][2] = unorm5_to_8_neon(vandq_u16(vshrq_n_u16(p16[i], 10), vdupq_n_u16(0x1F)));
+            c16[i][3] = vmulq_n_u16(vshrq_n_u16(p16[i], 15), 0xFF);
+        }
+        for (u32 j = 0; j < 4; j++)
+            comp[j] = narrow_u16_neon(c16[0][j], c16[1][j]);
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGBX8:
+        p8x4 = vld4q_u8(in_data);
+        comp[0] = p8x4.val[0];
+        comp[1] = p8x4.val[1];
+        comp[2] = p8x4.val[2];
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGB10A2:
+        for (u32 i = 0; i < 4; i++)
+        {
+            p32 = vld1q_u32((const u32*)(in_data + i * 16));
+            c32[0][i] = unorm10_to_8_neon(vandq_u32(p32, vdupq_n_u32(0x3FF)));
+            c32[1][i] = unorm10_to_8_neon(vandq_u32(vshrq_n_u32(p32, 10), vdupq_n_u32(0x3FF)));
+            c32[2][i] = unorm10_to_8_neon(vandq_u32(vshrq_n_u32(p32, 20), vdupq_n_u32(0x3FF)));
+            c32[3][i] = vmulq_n_u32(vshrq_n_u32(p32, 30), 85);
+        }
+        for (u32 j = 0; j < 4; j++)
+            comp[j] = narrow_u32_neon(c32[j]);
+        break;
+    case TEX_FORMAT_UTILS_FORMAT_RGBA8:
+        p8x4 = vld4q_u8(in_data);
+        comp[0] = p8x4.val[0];
+        comp[1] = p8x4.val[1];
+        comp[2] = p8x4.val[2];
+        comp[3] = p8x4.val[3];
+        break;
+    }
+}
+
+template <TexFormatUtilsFormat format>
+static u32 to_rgba8_neon(const u8* in_data, u8* out_data, u32 num_pixels,
+                         const TexFormatUtilsComponent comp_sel[4])
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+
+    u32 i = 0;
+    for (; i + 16 <= num_pixels; i += 16)
+    {
+        uint8x16_t comp[6];
+        expand_pixels_neon(in_data + i * bpp, format, comp);
+        comp[TEX_FORMAT_UTILS_COMPONENT_0] = vdupq_n_u8(0);
+        comp[TEX_FORMAT_UTILS_COMPONENT_1] = vdupq_n_u8(0xFF);
+
+        uint8x16x4_t rgba;
+        rgba.val[0] = comp[comp_sel[0]];
+        rgba.val[1] = comp[comp_sel[1]];
+        rgba.val[2] = comp[comp_sel[2]];
+        rgba.val[3] = comp[comp_sel[3]];
+        vst4q_u8(out_data + i * 4, rgba);
+    }
+
+    return i;
+}
+
+#define TEX_FORMAT_UTILS_NEON_ENTRY(format) to_rgba8_neon<format>
+
+static const TexFormatUtilsToRGBA8Func to_rgba8_neon_table[TEX_FORMAT_UTILS_NUM_FORMATS] =
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_NEON_ENTRY);
+
+#endif
+
+// SIMD converter of a format, if any for this host
+static TexFormatUtilsToRGBA8Func select_to_rgba8(TexFormatUtilsFormat format)
+{
+    const u32 features = CPUFeatures_Get();
+
+#if defined(TEX_FORMAT_UTILS_KERNELS_X86)
+    if (features & CPU_FEATURE_AVX2)
+        return to_rgba8_avx2_table[format];
+
+    if (features & CPU_FEATURE_SSSE3)
+        return to_rgba8_ssse3_table[format];
+#elif defined(TEX_FORMAT_UTILS_KERNELS_NEON)
+    if (features & CPU_FEATURE_NEON)
+        return to_rgba8_neon_table[format];
+#endif
+
+    (void)features;
+    return NULL;
+}
+
+// RGBA8 to native formats.
+// Components are quantized as (c * max + d) / 255, where max is the
+// largest value of the component in the target format and d is 127 to
+// round to the nearest value, or the threshold of the pixel in a 4x4
+// ordered (Bayer) dither pattern, anchored at the top-left pixel of the
+// image, when dithering.
+// The converters work on a run of pixels of a row starting at a column
+// that is a multiple of 4, with dither[i] the threshold of column i % 4.
+
+// Converts the first num_pixels pixels of in_data and returns how many
+// were converted
+typedef u32 (*TexFormatUtilsFromRGBA8Func)(const u8* in_data, u8* out_data, u32 num_pixels, const u16 dither[4]);
+
+// (2 * b + 1) * 255 / 32 for the 4x4 Bayer matrix entries b
+static const u16 dither_thresholds[4][4] = {
+    {   7, 135,  39, 167 },
+    { 199,  71, 231, 103 },
+    {  55, 183,  23, 151 },
+    { 247, 119, 215,  87 }
+};
+
+static const u16 no_dither_thresholds[4] = { 127, 127, 127, 127 };
+
+static inline u32 quantize(u32 c, u32 max, u32 d)
+{
+    return (c * max + d) / 255;
+}
+
+// Packs a pixel given as RGBA8 in the format
+template <TexFormatUtilsFormat format>
+static inline u32 pack_pixel(const u8* rgba, u32 d)
+{
+    switch (format)
+    {
+    case TEX_FORMAT_UTILS_FORMAT_L8:
+        return rgba[0];
+    case TEX_FORMAT_UTILS_FORMAT_LA8:
+        return rgba[0] | rgba[1] << 8;
+    case TEX_FORMAT_UTILS_FORMAT_LA4:
+        return quantize(rgba[0], 0xF, d) | quantize(rgba[1], 0xF, d) << 4;
+    case TEX_FORMAT_UTILS_FORMAT_RGB565:
+        return quantize(rgba[0], 0x1F, d) | quantize(rgba[1], 0x3F, d) << 5 | quantize(rgba[2], 0x1F, d) << 11;
+    case TEX_FORMAT_UTILS_FORMAT_RGB5A1:
+        return quantize(rgba[0], 0x1F, d) | quantize(rgba[1], 0x1F, d) << 5 | quantize(rgba[2], 0x1F, d) << 10 | quantize(rgba[3], 0x1, d) << 15;
+    case TEX_FORMAT_UTILS_FORMAT_RGBA4:
+        return quantize(rgba[0], 0xF, d) | quantize(rgba[1], 0xF, d) << 4 | quantize(rgba[2], 0xF, d) << 8 | quantize(rgba[3], 0xF, d) << 12;
+    case TEX_FORMAT_UTILS_FORMAT_RGBX8:
+        return rgba[0] | rgba[1] << 8 | rgba[2] << 16 | 0xFF000000;
+    case TEX_FORMAT_UTILS_FORMAT_RGB10A2:
+        return quantize(rgba[0], 0x3FF, d) | quantize(rgba[1], 0x3FF, d) << 10 | quantize(rgba[2], 0x3FF, d) << 20 | quantize(rgba[3], 0x3, d) << 30;
+    case TEX_FORMAT_UTILS_FORMAT_RGBA8:
+        return rgba[0] | rgba[1] << 8 | rgba[2] << 16 | (u32)rgba[3] << 24;
+    }
+
+    return 0;
+}
+
+template <TexFormatUtilsFormat format>
+static u32 from_rgba8_generic(const u8* in_data, u8* out_data, u32 num_pixels, const u16 dither[4])
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+
+    for (u32 pixel_idx = 0; pixel_idx < num_pixels; pixel_idx++)
+    {
+        const u32 pixel = pack_pixel<format>(in_data + pixel_idx * 4, dither[pixel_idx & 3]);
+
+        /* Write pixel data in little endian */
+
+        u8* out_pixel = out_data + pixel_idx * bpp;
+        for (u32 i = 0; i < bpp; i++)
+            out_pixel[i] = pixel >> (i * 8);
+    }
+
+    return num_pixels;
+}
+
+#define TEX_FORMAT_UTILS_FROM_GENERIC_ENTRY(format) from_rgba8_generic<format>
+
+static const TexFormatUtilsFromRGBA8Func from_rgba8_generic_table[TEX_FORMAT_UTILS_NUM_FORMATS] =
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_FROM_GENERIC_ENTRY);
+
+// SIMD packers.
+// Each component of the pixels is gathered to its own vector of 16-bit
+// lanes, quantized, and the components are then shifted into place.
+// Divisions by 255 are exact over the range of the quantized values
+// (at most 255 * 63 + 254):
+//   x / 255 == mulhi(x, 16449) >> 6 == (x + 1 + (x >> 8)) >> 8
+// 10-bit components are quantized as c * 4 + (c * 3 + d) / 255.
+
+#if defined(TEX_FORMAT_UTILS_KERNELS_X86)
+
+// Gathers component c of 8 RGBA8 pixels (4 in lo, 4 in hi) to 16-bit lanes
+static inline CPU_FEATURES_TARGET_SSSE3 __m128i gather_component_ssse3(__m128i lo, __m128i hi, int c)
+{
+    const __m128i shuffle_lo = _mm_setr_epi8(c, -1, c + 4, -1, c + 8, -1, c + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i shuffle_hi = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, c, -1, c + 4, -1, c + 8, -1, c + 12, -1);
+
+    return _mm_or_si128(_mm_shuffle_epi8(lo, shuffle_lo), _mm_shuffle_epi8(hi, shuffle_hi));
+}
+
+static inline CPU_FEATURES_TARGET_SSSE3 __m128i quantize_ssse3(__m128i c, short max, __m128i d)
+{
+    const __m128i x = _mm_add_epi16(_mm_mullo_epi16(c, _mm_set1_epi16(max)), d);
+    return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(16449)), 6);
+}
+
+static inline CPU_FEATURES_TARGET_SSSE3 __m128i quantize10_ssse3(__m128i c, __m128i d)
+{
+    return _mm_add_epi16(_mm_slli_epi16(c, 2), quantize_ssse3(c, 3, d));
+}
+
+template <TexFormatUtilsFormat format>
+static CPU_FEATURES_TARGET_SSSE3 u32 from_rgba8_ssse3(const u8* in_data, u8* out_data, u32 num_pixels, const u16 dither[4])
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+    const __m128i d = _mm_set1_epi64x((long long)((u64)dither[0] | (u64)dither[1] << 16 | (u64)dither[2] << 32 | (u64)dither[3] << 48));
+
+    u32 i = 0;
+    for (; i + 8 <= num_pixels; i += 8)
+    {
+        const __m128i lo = _mm_loadu_si128((const __m128i*)(in_data + i * 4));
+        const __m128i hi = _mm_loadu_si128((const __m128i*)(in_data + i * 4 + 16));
+        u8* out = out_data + i * bpp;
+
+        __m128i r, g, b, a, p;
+
+        switch (format)
+        {
+        case TEX_FORMAT_UTILS_FORMAT_L8:
+            r = gather_component_ssse3(lo, hi, 0);
+            _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(r, r));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_LA8:
+            r = gather_component_ssse3(lo, hi, 0);
+            g = gather_component_ssse3(lo, hi, 1);
+            _mm_storeu_si128((__m128i*)out, _mm_or_si128(r, _mm_slli_epi16(g, 8)));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_LA4:
+            r = quantize_ssse3(gather_component_ssse3(lo, hi, 0), 0xF, d);
+            g = quantize_ssse3(gather_component_ssse3(lo, hi, 1), 0xF, d);
+            p = _mm_or_si128(r, _mm_slli_epi16(g, 4));
+            _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(p, p));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGB565:
+            r = quantize_ssse3(gather_component_ssse3(lo, hi, 0), 0x1F, d);
+            g = quantize_ssse3(gather_component_ssse3(lo, hi, 1), 0x3F, d);
+            b = quantize_ssse3(gather_component_ssse3(lo, hi, 2), 0x1F, d);
+            _mm_storeu_si128((__m128i*)out, _mm_or_si128(_mm_or_si128(r, _mm_slli_epi16(g, 5)), _mm_slli_epi16(b, 11)));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGB5A1:
+            r = quantize_ssse3(gather_component_ssse3(lo, hi, 0), 0x1F, d);
+            g = quantize_ssse3(gather_component_ssse3(lo, hi, 1), 0x1F, d);
+            b = quantize_ssse3(gather_component_ssse3(lo, hi, 2), 0x1F, d);
+            a = quantize_ssse3(gather_component_ssse3(lo, hi, 3), 0x1,  d);
+            _mm_storeu_si128((__m128i*)out, _mm_or_si128(_mm_or_si128(r, _mm_slli_epi16(g, 5)), _mm_or_si128(_mm_slli_epi16(b, 10), _mm_slli_epi16(a, 15))));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGBA4:
+            r = quantize_ssse3(gather_component_ssse3(lo, hi, 0), 0xF, d);
+            g = quantize_ssse3(gather_component_ssse3(lo, hi, 1), 0xF, d);
+            b = quantize_ssse3(gather_component_ssse3(lo, hi, 2), 0xF, d);
+            a = quantize_ssse3(gather_component_ssse3(lo, hi, 3), 0xF, d);
+            _mm_storeu_si128((__m128i*)out, _mm_or_si128(_mm_or_si128(r, _mm_slli_epi16(g, 4)), _mm_or_si128(_mm_slli_epi16(b, 8), _mm_slli_epi16(a, 12))));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGBX8:
+            _mm_storeu_si128((__m128i*)out,        _mm_or_si128(lo, _mm_set1_epi32((int)0xFF000000)));
+            _mm_storeu_si128((__m128i*)(out + 16), _mm_or_si128(hi, _mm_set1_epi32((int)0xFF000000)));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGB10A2:
+            r = quantize10_ssse3(gather_component_ssse3(lo, hi, 0), d);
+            g = quantize10_ssse3(gather_component_ssse3(lo, hi, 1), d);
+            b = quantize10_ssse3(gather_component_ssse3(lo, hi, 2), d);
+            a = quantize_ssse3(gather_component_ssse3(lo, hi, 3), 0x3, d);
+            // Low and high halves of the pixels
+            p = _mm_or_si128(r, _mm_slli_epi16(g, 10));
+            a = _mm_or_si128(_mm_or_si128(_mm_srli_epi16(g, 6), _mm_slli_epi16(b, 4)), _mm_slli_epi16(a, 14));
+            _mm_storeu_si128((__m128i*)out,        _mm_unpacklo_epi16(p, a));
+            _mm_storeu_si128((__m128i*)(out + 16), _mm_unpackhi_epi16(p, a));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGBA8:
+            _mm_storeu_si128((__m128i*)out,        lo);
+            _mm_storeu_si128((__m128i*)(out + 16), hi);
+            break;
+        }
+    }
+
+    return i;
+}
+
+#define TEX_FORMAT_UTILS_FROM_SSSE3_ENTRY(format) from_rgba8_ssse3<format>
+
+static const TexFormatUtilsFromRGBA8Func from_rgba8_ssse3_table[TEX_FORMAT_UTILS_NUM_FORMATS] =
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_FROM_SSSE3_ENTRY);
+
+// AVX2 versions of the above, on 16 pixels.
+// The 128-bit halves of the input are reordered so that the gathered
+// components are in pixel order.
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i gather_component_avx2(__m256i lo, __m256i hi, int c)
+{
+    const __m256i shuffle_lo = _mm256_broadcastsi128_si256(_mm_setr_epi8(c, -1, c + 4, -1, c + 8, -1, c + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    const __m256i shuffle_hi = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, c, -1, c + 4, -1, c + 8, -1, c + 12, -1));
+
+    return _mm256_or_si256(_mm256_shuffle_epi8(lo, shuffle_lo), _mm256_shuffle_epi8(hi, shuffle_hi));
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i quantize_avx2(__m256i c, short max, __m256i d)
+{
+    const __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(c, _mm256_set1_epi16(max)), d);
+    return _mm256_srli_epi16(_mm256_mulhi_epu16(x, _mm256_set1_epi16(16449)), 6);
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 __m256i quantize10_avx2(__m256i c, __m256i d)
+{
+    return _mm256_add_epi16(_mm256_slli_epi16(c, 2), quantize_avx2(c, 3, d));
+}
+
+static inline CPU_FEATURES_TARGET_AVX2 void store_bytes_avx2(u8* out, __m256i p)
+{
+    _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(p, p), 0x08)));
+}
+
+template <TexFormatUtilsFormat format>
+static CPU_FEATURES_TARGET_AVX2 u32 from_rgba8_avx2(const u8* in_data, u8* out_data, u32 num_pixels, const u16 dither[4])
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+    const __m256i d = _mm256_set1_epi64x((long long)((u64)dither[0] | (u64)dither[1] << 16 | (u64)dither[2] << 32 | (u64)dither[3] << 48));
+
+    u32 i = 0;
+    for (; i + 16 <= num_pixels; i += 16)
+    {
+        const __m256i v0 = _mm256_loadu_si256((const __m256i*)(in_data + i * 4));
+        const __m256i v1 = _mm256_loadu_si256((const __m256i*)(in_data + i * 4 + 32));
+        const __m256i lo = _mm256_permute2x128_si256(v0, v1, 0x20);
+        const __m256i hi = _mm256_permute2x128_si256(v0, v1, 0x31);
+        u8* out = out_data + i * bpp;
+
+        __m256i r, g, b, a, p;
+
+        switch (format)
+        {
+        case TEX_FORMAT_UTILS_FORMAT_L8:
+            store_bytes_avx2(out, gather_component_avx2(lo, hi, 0));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_LA8:
+            r = gather_component_avx2(lo, hi, 0);
+            g = gather_component_avx2(lo, hi, 1);
+            _mm256_storeu_si256((__m256i*)out, _mm256_or_si256(r, _mm256_slli_epi16(g, 8)));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_LA4:
+            r = quantize_avx2(gather_component_avx2(lo, hi, 0), 0xF, d);
+            g = quantize_avx2(gather_component_avx2(lo, hi, 1), 0xF, d);
+            store_bytes_avx2(out, _mm256_or_si256(r, _mm256_slli_epi16(g, 4)));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGB565:
+            r = quantize_avx2(gather_component_avx2(lo, hi, 0), 0x1F, d);
+            g = quantize_avx2(gather_component_avx2(lo, hi, 1), 0x3F, d);
+            b = quantize_avx2(gather_component_avx2(lo, hi, 2), 0x1F, d);
+            _mm256_storeu_si256((__m256i*)out, _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi16(g, 5)), _mm256_slli_epi16(b, 11)));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGB5A1:
+            r = quantize_avx2(gather_component_avx2(lo, hi, 0), 0x1F, d);
+            g = quantize_avx2(gather_component_avx2(lo, hi, 1), 0x1F, d);
+            b = quantize_avx2(gather_component_avx2(lo, hi, 2), 0x1F, d);
+            a = quantize_avx2(gather_component_avx2(lo, hi, 3), 0x1,  d);
+            _mm256_storeu_si256((__m256i*)out, _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi16(g, 5)), _mm256_or_si256(_mm256_slli_epi16(b, 10), _mm256_slli_epi16(a, 15))));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGBA4:
+            r = quantize_avx2(gather_component_avx2(lo, hi, 0), 0xF, d);
+            g = quantize_avx2(gather_component_avx2(lo, hi, 1), 0xF, d);
+            b = quantize_avx2(gather_component_avx2(lo, hi, 2), 0xF, d);
+            a = quantize_avx2(gather_component_avx2(lo, hi, 3), 0xF, d);
+            _mm256_storeu_si256((__m256i*)out, _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi16(g, 4)), _mm256_or_si256(_mm256_slli_epi16(b, 8), _mm256_slli_epi16(a, 12))));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGBX8:
+            _mm256_storeu_si256((__m256i*)out,        _mm256_or_si256(v0, _mm256_set1_epi32((int)0xFF000000)));
+            _mm256_storeu_si256((__m256i*)(out + 32), _mm256_or_si256(v1, _mm256_set1_epi32((int)0xFF000000)));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGB10A2:
+            r = quantize10_avx2(gather_component_avx2(lo, hi, 0), d);
+            g = quantize10_avx2(gather_component_avx2(lo, hi, 1), d);
+            b = quantize10_avx2(gather_component_avx2(lo, hi, 2), d);
+            a = quantize_avx2(gather_component_avx2(lo, hi, 3), 0x3, d);
+            // Low and high halves of the pixels, interleaved within each
+            // 128-bit lane, then put back in pixel order
+            p = _mm256_or_si256(r, _mm256_slli_epi16(g, 10));
+            a = _mm256_or_si256(_mm256_or_si256(_mm256_srli_epi16(g, 6), _mm256_slli_epi16(b, 4)), _mm256_slli_epi16(a, 14));
+            r = _mm256_unpacklo_epi16(p, a);
+            g = _mm256_unpackhi_epi16(p, a);
+            _mm256_storeu_si256((__m256i*)out,        _mm256_permute2x128_si256(r, g, 0x20));
+            _mm256_storeu_si256((__m256i*)(out + 32), _mm256_permute2x128_si256(r, g, 0x31));
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGBA8:
+            _mm256_storeu_si256((__m256i*)out,        v0);
+            _mm256_storeu_si256((__m256i*)(out + 32), v1);
+            break;
+        }
+    }
+
+    return i;
+}
+
+#define TEX_FORMAT_UTILS_FROM_AVX2_ENTRY(format) from_rgba8_avx2<format>
+
+static const TexFormatUtilsFromRGBA8Func from_rgba8_avx2_table[TEX_FORMAT_UTILS_NUM_FORMATS] =
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_FROM_AVX2_ENTRY);
+
+#elif defined(TEX_FORMAT_UTILS_KERNELS_NEON)
+
+// NEON versions, on 16 pixels loaded to one vector per component and
+// quantized in two halves of 8.
+
+static inline uint16x8_t quantize_neon(uint8x8_t c, u8 max, uint16x8_t d)
+{
+    const uint16x8_t x = vaddq_u16(vmull_u8(c, vdup_n_u8(max)), d);
+    return vshrq_n_u16(vaddq_u16(vsraq_n_u16(x, x, 8), vdupq_n_u16(1)), 8);
+}
+
+static inline uint16x8_t quantize10_neon(uint8x8_t c, uint16x8_t d)
+{
+    return vaddq_u16(vshll_n_u8(c, 2), quantize_neon(c, 3, d));
+}
+
+template <TexFormatUtilsFormat format>
+static u32 from_rgba8_neon(const u8* in_data, u8* out_data, u32 num_pixels, const u16 dither[4])
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+    const uint16x8_t d = vcombine_u16(vld1_u16(dither), vld1_u16(dither));
+
+    u32 i = 0;
+    for (; i + 16 <= num_pixels; i += 16)
+    {
+        uint8x16x4_t rgba = vld4q_u8(in_data + i * 4);
+        u8* out = out_data + i * bpp;
+
+        uint8x16x2_t p8;
+        uint16x8x2_t p16;
+        uint16x8_t r, g, b, a;
+
+        switch (format)
+        {
+        case TEX_FORMAT_UTILS_FORMAT_L8:
+            vst1q_u8(out, rgba.val[0]);
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_LA8:
+            p8.val[0] = rgba.val[0];
+            p8.val[1] = rgba.val[1];
+            vst2q_u8(out, p8);
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_LA4:
+            for (u32 h = 0; h < 2; h++)
+            {
+                const uint8x8_t rh = h ? vget_high_u8(rgba.val[0]) : vget_low_u8(rgba.val[0]);
+                const uint8x8_t gh = h ? vget_high_u8(rgba.val[1]) : vget_low_u8(rgba.val[1]);
+                vst1_u8(out + h * 8, vmovn_u16(vorrq_u16(quantize_neon(rh, 0xF, d), vshlq_n_u16(quantize_neon(gh, 0xF, d), 4))));
+            }
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGB565:
+        case TEX_FORMAT_UTILS_FORMAT_RGB5A1:
+        case TEX_FORMAT_UTILS_FORMAT_RGBA4:
+            for (u32 h = 0; h < 2; h++)
+            {
+                const uint8x8_t rh = h ? vget_high_u8(rgba.val[0]) : vget_low_u8(rgba.val[0]);
+                const uint8x8_t gh = h ? vget_high_u8(rgba.val[1]) : vget_low_u8(rgba.val[1]);
+                const uint8x8_t bh = h ? vget_high_u8(rgba.val[2]) : vget_low_u8(rgba.val[2]);
+                const uint8x8_t ah = h ? vget_high_u8(rgba.val[3]) : vget_low_u8(rgba.val[3]);
+
+                if (format == TEX_FORMAT_UTILS_FORMAT_RGB565)
+                {
+                    r = quantize_neon(rh, 0x1F, d);
+                    g = vshlq_n_u16(quantize_neon(gh, 0x3F, d), 5);
+                    b = vshlq_n_u16(quantize_neon(bh, 0x1F, d), 11);
+                    a = vdupq_n_u16(0);
+                }
+                else if (format == TEX_FORMAT_UTILS_FORMAT_RGB5A1)
+                {
+                    r = quantize_neon(rh, 0x1F, d);
+                    g = vshlq_n_u16(quantize_neon(gh, 0x1F, d), 5);
+                    b = vshlq_n_u16(quantize_neon(bh, 0x1F, d), 10);
+                    a = vshlq_n_u16(quantize_neon(ah, 0x1,  d), 15);
+                }
+                else
+                {
+                    r = quantize_neon(rh, 0xF, d);
+                    g = vshlq_n_u16(quantize_neon(gh, 0xF, d), 4);
+                    b = vshlq_n_u16(quantize_neon(bh, 0xF, d), 8);
+                    a = vshlq_n_u16(quantize_neon(ah, 0xF, d), 12);
+                }
+
+                vst1q_u16((u16*)(out + h * 16), vorrq_u16(vorrq_u16(r, g), vorrq_u16(b, a)));
+            }
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGBX8:
+            rgba.val[3] = vdupq_n_u8(0xFF);
+            vst4q_u8(out, rgba);
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGB10A2:
+            for (u32 h = 0; h < 2; h++)
+            {
+                const uint8x8_t rh = h ? vget_high_u8(rgba.val[0]) : vget_low_u8(rgba.val[0]);
+                const uint8x8_t gh = h ? vget_high_u8(rgba.val[1]) : vget_low_u8(rgba.val[1]);
+                const uint8x8_t bh = h ? vget_high_u8(rgba.val[2]) : vget_low_u8(rgba.val[2]);
+                const uint8x8_t ah = h ? vget_high_u8(rgba.val[3]) : vget_low_u8(rgba.val[3]);
+
+                r = quantize10_neon(rh, d);
+                g = quantize10_neon(gh, d);
+                b = quantize10_neon(bh, d);
+                a = quantize_neon(ah, 0x3, d);
+
+                // Low and high halves of the pixels
+                p16.val[0] = vorrq_u16(r, vshlq_n_u16(g, 10));
+                p16.val[1] = vorrq_u16(vorrq_u16(vshrq_n_u16(g, 6), vshlq_n_u16(b, 4)), vshlq_n_u16(a, 14));
+                vst2q_u16((u16*)(out + h * 32), p16);
+            }
+            break;
+        case TEX_FORMAT_UTILS_FORMAT_RGBA8:
+            vst4q_u8(out, rgba);
+            break;
+        }
+    }
+
+    return i;
+}
+
+#define TEX_FORMAT_UTILS_FROM_NEON_ENTRY(format) from_rgba8_neon<format>
+
+static const TexFormatUtilsFromRGBA8Func from_rgba8_neon_table[TEX_FORMAT_UTILS_NUM_FORMATS] =
+    TEX_FORMAT_UTILS_FORMAT_TABLE(TEX_FORMAT_UTILS_FROM_NEON_ENTRY);
+
+#endif
+
+// SIMD packer of a format, if any for this host
+static TexFormatUtilsFromRGBA8Func select_from_rgba8(TexFormatUtilsFormat format)
+{
+    const u32 features = CPUFeatures_Get();
+
+#if defined(TEX_FORMAT_UTILS_KERNELS_X86)
+    if (features & CPU_FEATURE_AVX2)
+        return from_rgba8_avx2_table[format];
+
+    if (features & CPU_FEATURE_SSSE3)
+        return from_rgba8_ssse3_table[format];
+#elif defined(TEX_FORMAT_UTILS_KERNELS_NEON)
+    if (features & CPU_FEATURE_NEON)
+        return from_rgba8_neon_table[format];
+#endif
+
+    (void)features;
+    return NULL;
+}
+
+extern "C"
+{
+
+void TexFormatUtils_ToRGBA8(u32 width, u32 height,
+                            const u8* in_data,
+                            u8* out_data,
+                            TexFormatUtilsFormat format,
+                            TexFormatUtilsComponent comp_r_sel,
+                            TexFormatUtilsComponent comp_g_sel,
+                            TexFormatUtilsComponent comp_b_sel,
+                            TexFormatUtilsComponent comp_a_sel)
+{
+    const TexFormatUtilsComponent comp_sel[4] = { comp_r_sel, comp_g_sel, comp_b_sel, comp_a_sel };
+
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+    if (bpp == 0)
+        return;
+
+    const bool identity = comp_r_sel == TEX_FORMAT_UTILS_COMPONENT_R && comp_g_sel == TEX_FORMAT_UTILS_COMPONENT_G &&
+                          comp_b_sel == TEX_FORMAT_UTILS_COMPONENT_B && comp_a_sel == TEX_FORMAT_UTILS_COMPONENT_A;
+
+    const u32 num_pixels = width * height;
+    u32 converted = 0;
+
+    const TexFormatUtilsToRGBA8Func to_rgba8_simd = select_to_rgba8(format);
+    if (to_rgba8_simd)
+        converted = to_rgba8_simd(in_data, out_data, num_pixels, comp_sel);
+
+    to_rgba8_generic_table[identity][format](in_data + converted * bpp, out_data + converted * 4,
+                                             num_pixels - converted, comp_sel);
+}
+
+
+void TexFormatUtils_FromRGBA8(u32 width, u32 height,
+                              const u8* in_data,
+                              u8* out_data,
+                              TexFormatUtilsFormat format,
+                              bool dither)
+{
+    const u32 bpp = TexFormatUtils_GetFormatBPP(format);
+    if (bpp == 0)
+        return;
+
+    // Without dithering, the image is a single run of pixels
+    if (!dither)
+    {
+        width *= height;
+        height = 1;
+    }
+
+    const TexFormatUtilsFromRGBA8Func from_rgba8_simd = select_from_rgba8(format);
+    const TexFormatUtilsFromRGBA8Func from_rgba8_generic = from_rgba8_generic_table[format];
+
+    for (u32 y = 0; y < height; y++)
+    {
+        const u16* thresholds = dither ? dither_thresholds[y & 3] : no_dither_thresholds;
+        const u8* in_row = in_data + (size_t)y * width * 4;
+        u8* out_row = out_data + (size_t)y * width * bpp;
+
+        u32 converted = 0;
+        if (from_rgba8_simd)
+            converted = from_rgba8_simd(in_row, out_row, width, thresholds);
+
+        from_rgba8_generic(in_row + converted * 4, out_row + converted * bpp, width - converted, thresholds);
+    }
+}
+
+}
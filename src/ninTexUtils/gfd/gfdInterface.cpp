@@ -98,7 +98,17 @@ void LoadGFDBlockHeader(const void* data, GFDBlockHeader* block, bool serialized
 
 }
 
-size_t GFDFile::load(const void* data)
+static inline void* LoadGFDBlockData(const u8* data, u32 size, bool borrowData)
+{
+    if (borrowData)
+        return const_cast<u8*>(data);
+
+    u8* ptr = new u8[size];
+    std::memcpy(ptr, data, size);
+    return ptr;
+}
+
+size_t GFDFile::load(const void* data, bool borrowData)
 {
     // Re-initialize the file
     destroy();
@@ -154,8 +164,7 @@ size_t GFDFile::load(const void* data)
         {
             assert(currentVertexShader != NULL && currentVertexShader->shaderPtr == NULL);
             assert(blockDataSize == currentVertexShader->shaderSize);
-            currentVertexShader->shaderPtr = new u8[blockDataSize];
-            std::memcpy(currentVertexShader->shaderPtr, data_u8, blockDataSize);
+            currentVertexShader->shaderPtr = LoadGFDBlockData(data_u8, blockDataSize, borrowData);
         }
         else if (blockType == GFD_BLOCK_TYPE_GX2_PS_HEADER)
         {
@@ -168,8 +177,7 @@ size_t GFDFile::load(const void* data)
         {
             assert(currentPixelShader != NULL && currentPixelShader->shaderPtr == NULL);
             assert(blockDataSize == currentPixelShader->shaderSize);
-            currentPixelShader->shaderPtr = new u8[blockDataSize];
-            std::memcpy(currentPixelShader->shaderPtr, data_u8, blockDataSize);
+            currentPixelShader->shaderPtr = LoadGFDBlockData(data_u8, blockDataSize, borrowData);
         }
         else if (blockType == GFD_BLOCK_TYPE_GX2_GS_HEADER)
         {
@@ -182,16 +190,14 @@ size_t GFDFile::load(const void* data)
         {
             assert(currentGeometryShader != NULL && currentGeometryShader->shaderPtr == NULL);
             assert(blockDataSize == currentGeometryShader->shaderSize);
-            currentGeometryShader->shaderPtr = new u8[blockDataSize];
-            std::memcpy(currentGeometryShader->shaderPtr, data_u8, blockDataSize);
+            currentGeometryShader->shaderPtr = LoadGFDBlockData(data_u8, blockDataSize, borrowData);
         }
         else if ((blockVersion == 0 && blockTypeV0 == GFD_BLOCK_TYPE_V0_GX2_GS_COPY_PROGRAM) ||
                  (blockVersion == 1 && blockTypeV1 == GFD_BLOCK_TYPE_V1_GX2_GS_COPY_PROGRAM))
         {
             assert(currentGeometryShader != NULL && currentGeometryShader->copyShaderPtr == NULL);
             assert(blockDataSize == currentGeometryShader->copyShaderSize);
-            currentGeometryShader->copyShaderPtr = new u8[blockDataSize];
-            std::memcpy(currentGeometryShader->copyShaderPtr, data_u8, blockDataSize);
+            currentGeometryShader->copyShaderPtr = LoadGFDBlockData(data_u8, blockDataSize, borrowData);
         }
         else if ((blockVersion == 0 && blockTypeV0 == GFD_BLOCK_TYPE_V0_GX2_TEX_HEADER) ||
                  (blockVersion == 1 && blockTypeV1 == GFD_BLOCK_TYPE_V1_GX2_TEX_HEADER))
@@ -206,16 +212,14 @@ size_t GFDFile::load(const void* data)
         {
             assert(currentTexture != NULL && currentTexture->surface.imagePtr == NULL);
             assert(blockDataSize == currentTexture->surface.imageSize);
-            currentTexture->surface.imagePtr = new u8[blockDataSize];
-            std::memcpy(currentTexture->surface.imagePtr, data_u8, blockDataSize);
+            currentTexture->surface.imagePtr = LoadGFDBlockData(data_u8, blockDataSize, borrowData);
         }
         else if ((blockVersion == 0 && blockTypeV0 == GFD_BLOCK_TYPE_V0_GX2_TEX_MIP_DATA) ||
                  (blockVersion == 1 && blockTypeV1 == GFD_BLOCK_TYPE_V1_GX2_TEX_MIP_DATA))
         {
             assert(currentTexture != NULL && currentTexture->surface.mipPtr == NULL);
             assert(blockDataSize == currentTexture->surface.mipSize);
-            currentTexture->surface.mipPtr = new u8[blockDataSize];
-            std::memcpy(currentTexture->surface.mipPtr, data_u8, blockDataSize);
+            currentTexture->surface.mipPtr = LoadGFDBlockData(data_u8, blockDataSize, borrowData);
         }
 
         data_u8 += blockDataSize;
@@ -224,6 +228,12 @@ size_t GFDFile::load(const void* data)
     if (searchAlignmentBlock)
         mHeader.alignMode = GFD_ALIGN_MODE_DISABLE;
 
+    if (borrowData)
+    {
+        mBorrowedBegin = data;
+        mBorrowedEnd = data_u8;
+    }
+
     return (uintptr_t)data_u8 - (uintptr_t)data;
 }
 
@@ -353,9 +363,9 @@ void GFDFile::destroy()
     for (u32 i = 0; i < mTextures.size(); i++)
     {
         GX2Texture& texture = mTextures[i];
-        if (texture.surface.imagePtr)
+        if (texture.surface.imagePtr && !isDataBorrowed(texture.surface.imagePtr))
             delete[] (u8*)texture.surface.imagePtr;
-        if (texture.surface.mipPtr)
+        if (texture.surface.mipPtr && !isDataBorrowed(texture.surface.mipPtr))
             delete[] (u8*)texture.surface.mipPtr;
     }
 
@@ -365,7 +375,7 @@ void GFDFile::destroy()
     {
         GX2VertexShader& shader = mVertexShaders[i];
 
-        if (shader.shaderPtr)
+        if (shader.shaderPtr && !isDataBorrowed(shader.shaderPtr))
             delete[] (u8*)shader.shaderPtr;
 
         if (shader.uniformBlocks)
@@ -413,7 +423,7 @@ void GFDFile::destroy()
     {
         GX2PixelShader& shader = mPixelShaders[i];
 
-        if (shader.shaderPtr)
+        if (shader.shaderPtr && !isDataBorrowed(shader.shaderPtr))
             delete[] (u8*)shader.shaderPtr;
 
         if (shader.uniformBlocks)
@@ -453,10 +463,10 @@ void GFDFile::destroy()
     {
         GX2GeometryShader& shader = mGeometryShaders[i];
 
-        if (shader.shaderPtr)
+        if (shader.shaderPtr && !isDataBorrowed(shader.shaderPtr))
             delete[] (u8*)shader.shaderPtr;
 
-        if (shader.copyShaderPtr)
+        if (shader.copyShaderPtr && !isDataBorrowed(shader.copyShaderPtr))
             delete[] (u8*)shader.copyShaderPtr;
 
         if (shader.uniformBlocks)
@@ -493,4 +503,7 @@ void GFDFile::destroy()
     mGeometryShaders.clear();
 
   //mComputeShaders.clear();
+
+    mBorrowedBegin = NULL;
+    mBorrowedEnd = NULL;
 }
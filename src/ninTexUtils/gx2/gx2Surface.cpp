@@ -1,10 +1,29 @@
+#include <ninTexUtils/bcn/compress.h>
+#include <ninTexUtils/bcn/decompress.h>
+#include <ninTexUtils/cpu_features.h>
+#include <ninTexUtils/format_utils.h>
 #include <ninTexUtils/gx2/gx2Surface.h>
+#include <ninTexUtils/mip_utils.h>
+#include <ninTexUtils/thread_pool.h>
 #include <ninTexUtils/util.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <cstdio> // GX2SurfacePrintInfo
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define GX2_MICRO_TILE_KERNELS_X86 1
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define GX2_MICRO_TILE_KERNELS_NEON 1
+    #include <arm_neon.h>
+#endif
 
 extern "C"
 {
@@ -320,170 +339,1916 @@ void GX2CalcSurfaceSizeAndAlignment(GX2Surface* surf)
     }
 }
 
-void GX2CopySurface(const GX2Surface* src, u32 srcLevel, u32 srcSlice,
-                          GX2Surface* dst, u32 dstLevel, u32 dstSlice)
+} // extern "C"
+
+enum GX2MicroTileLayout
 {
-    GX2SurfaceFormat srcFormat = src->format;
-    GX2SurfaceFormat dstFormat = dst->format;
-    u32 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(srcFormat);
-    u32 bytesPerPixel = bitsPerPixel / 8;
-
-    ADDR_COMPUTE_SURFACE_INFO_OUTPUT srcAddrSurfInfo;
-    GX2ComputeLevelSurfaceInfo(src, srcLevel, &srcAddrSurfInfo);
-
-    ADDR_COMPUTE_SURFACE_INFO_OUTPUT dstAddrSurfInfo;
-    GX2ComputeLevelSurfaceInfo(dst, dstLevel, &dstAddrSurfInfo);
-
-    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT srcAddrFromCoordIn;
-    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT dstAddrFromCoordIn;
-    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT srcAddrFromCoordOut;
-    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT dstAddrFromCoordOut;
-
-    std::memset(&srcAddrFromCoordIn,  0, sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT));
-    std::memset(&dstAddrFromCoordIn,  0, sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT));
-    std::memset(&srcAddrFromCoordOut, 0, sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT));
-    std::memset(&dstAddrFromCoordOut, 0, sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT));
-
-    srcAddrFromCoordIn.size  = sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT);
-    dstAddrFromCoordIn.size  = sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT);
-    srcAddrFromCoordOut.size = sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT);
-    dstAddrFromCoordOut.size = sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT);
-
-    srcAddrFromCoordIn.slice = srcSlice;
-    srcAddrFromCoordIn.sample = 0;
-    srcAddrFromCoordIn.bpp = bitsPerPixel;
-    srcAddrFromCoordIn.pitch = srcAddrSurfInfo.pitch;
-    srcAddrFromCoordIn.height = srcAddrSurfInfo.height;
-    srcAddrFromCoordIn.numSlices = std::max(srcAddrSurfInfo.depth, 1u);
-    srcAddrFromCoordIn.numSamples = 1 << src->aa;
-    srcAddrFromCoordIn.tileMode = srcAddrSurfInfo.tileMode;
-    srcAddrFromCoordIn.isDepth = src->use & GX2_SURFACE_USE_DEPTH_BUFFER;
-    srcAddrFromCoordIn.tileBase = 0;
-    srcAddrFromCoordIn.compBits = 0;
-    //srcAddrFromCoordIn.numFrags = 0;
-
-    //ADDR_EXTRACT_BANKPIPE_SWIZZLE_INPUT srcExtractBankPipeSwizzleIn;
-    //srcExtractBankPipeSwizzleIn.size = sizeof(ADDR_EXTRACT_BANKPIPE_SWIZZLE_INPUT);
-    //ADDR_EXTRACT_BANKPIPE_SWIZZLE_OUTPUT srcExtractBankPipeSwizzleOut;
-    //srcExtractBankPipeSwizzleOut.size = sizeof(ADDR_EXTRACT_BANKPIPE_SWIZZLE_OUTPUT);
-
-    //srcExtractBankPipeSwizzleIn.base256b = src->swizzle >> 8 & 0xFF;
-    //AddrExtractBankPipeSwizzle(&srcExtractBankPipeSwizzleIn, &srcExtractBankPipeSwizzleOut);
-    //srcAddrFromCoordIn.pipeSwizzle = srcExtractBankPipeSwizzleOut.pipeSwizzle;
-    //srcAddrFromCoordIn.bankSwizzle = srcExtractBankPipeSwizzleOut.bankSwizzle;
+    GX2_MICRO_TILE_LAYOUT_OTHER,
+    GX2_MICRO_TILE_LAYOUT_ROW_MAJOR,    // Linear tile modes
+    GX2_MICRO_TILE_LAYOUT_DISPLAYABLE   // Thin displayable micro tiles
+};
 
-    R600AddrLib::ExtractBankPipeSwizzle(src->swizzle >> 8 & 0xFF,
-                                        &srcAddrFromCoordIn.bankSwizzle,
-                                        &srcAddrFromCoordIn.pipeSwizzle);
-
-    dstAddrFromCoordIn.slice = dstSlice;
-    dstAddrFromCoordIn.sample = 0;
-    dstAddrFromCoordIn.bpp = bitsPerPixel;
-    dstAddrFromCoordIn.pitch = dstAddrSurfInfo.pitch;
-    dstAddrFromCoordIn.height = dstAddrSurfInfo.height;
-    dstAddrFromCoordIn.numSlices = std::max(dstAddrSurfInfo.depth, 1u);
-    dstAddrFromCoordIn.numSamples = 1 << dst->aa;
-    dstAddrFromCoordIn.tileMode = dstAddrSurfInfo.tileMode;
-    dstAddrFromCoordIn.isDepth = dst->use & GX2_SURFACE_USE_DEPTH_BUFFER;
-    dstAddrFromCoordIn.tileBase = 0;
-    dstAddrFromCoordIn.compBits = 0;
-    //dstAddrFromCoordIn.numFrags = 0;
-
-    //ADDR_EXTRACT_BANKPIPE_SWIZZLE_INPUT dstExtractBankPipeSwizzleIn;
-    //dstExtractBankPipeSwizzleIn.size = sizeof(ADDR_EXTRACT_BANKPIPE_SWIZZLE_INPUT);
-    //ADDR_EXTRACT_BANKPIPE_SWIZZLE_OUTPUT dstExtractBankPipeSwizzleOut;
-    //dstExtractBankPipeSwizzleOut.size = sizeof(ADDR_EXTRACT_BANKPIPE_SWIZZLE_OUTPUT);
-
-    //dstExtractBankPipeSwizzleIn.base256b = dst->swizzle >> 8 & 0xFF;
-    //AddrExtractBankPipeSwizzle(&dstExtractBankPipeSwizzleIn, &dstExtractBankPipeSwizzleOut);
-    //dstAddrFromCoordIn.pipeSwizzle = dstExtractBankPipeSwizzleOut.pipeSwizzle;
-    //dstAddrFromCoordIn.bankSwizzle = dstExtractBankPipeSwizzleOut.bankSwizzle;
+// Everything needed to address one slice of one mip level of a surface,
+// independently of where its image data is located.
+// Elements are resolved a micro tile (8x8 elements) at a time: the address
+// of an element is the address of its micro tile's origin plus a fixed
+// offset within the micro tile. When that decomposition is possible, the
+// micro tile origins of the whole level are computed once, so copying the
+// level only consists of table lookups.
+// Plans are immutable once built and shared between threads.
+struct GX2TilingPlan
+{
+    u32  width;             // Level width, in elements
+    u32  height;            // Level height, in elements
+    u32  pitch;             // In elements
+    u32  bytesPerElem;
+    u32  sliceOffs;         // GX2_TILE_MODE_LINEAR_SPECIAL only, in elements
+    bool linearSpecial;
+
+    bool hasMicroTileOffs;
+    u32  microTileOffs[64];
+    u32  microTilesPerRow;
+    std::vector<u32> microTileAddrs;
+
+    // For the displayable layout, offset of each group of rows moved
+    // together by the micro tile kernels
+    GX2MicroTileLayout microTileLayout;
+    u32  microTileGroupOffs[8];
+
+    // Contiguous byte ranges covered by a full micro tile, relative to its
+    // origin, in increasing address order
+    u32  numMicroTileRuns;
+    u32  microTileRunOffs[64];
+    u32  microTileRunSizes[64];
+
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT addrFromCoordIn;
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC  addrFromCoordFunc;
+
+    size_t byteSize() const
+    {
+        return sizeof(GX2TilingPlan) + microTileAddrs.size() * sizeof(u32);
+    }
+};
 
-    R600AddrLib::ExtractBankPipeSwizzle(dst->swizzle >> 8 & 0xFF,
-                                        &dstAddrFromCoordIn.bankSwizzle,
-                                        &dstAddrFromCoordIn.pipeSwizzle);
+static inline u32 GX2ComputeTilingPlanElemAddr(const GX2TilingPlan* plan, u32 x, u32 y)
+{
+    if (plan->linearSpecial)
+        return (plan->sliceOffs + y * plan->pitch + x) * plan->bytesPerElem;
+
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT addrFromCoordIn = plan->addrFromCoordIn;
+    addrFromCoordIn.x = x;
+    addrFromCoordIn.y = y;
+
+    u32 bitPosition;
+    return (u32)plan->addrFromCoordFunc(&addrFromCoordIn, &bitPosition);
+}
+
+// Everything that GX2ComputeLevelSurfaceInfo and the address computation
+// depend on
+struct GX2TilingPlanKey
+{
+    GX2SurfaceDim dim;
+    u32           width;
+    u32           height;
+    u32           depth;
+    AddrFormat    format;
+    GX2AAMode     aa;
+    u32           use;
+    GX2TileMode   tileMode;
+    u32           swizzle;
+    u32           level;
+    u32           slice;
+    u32           bitsPerPixel;
+
+    bool operator==(const GX2TilingPlanKey& other) const
+    {
+        return dim          == other.dim          &&
+               width        == other.width        &&
+               height       == other.height       &&
+               depth        == other.depth        &&
+               format       == other.format       &&
+               aa           == other.aa           &&
+               use          == other.use          &&
+               tileMode     == other.tileMode     &&
+               swizzle      == other.swizzle      &&
+               level        == other.level        &&
+               slice        == other.slice        &&
+               bitsPerPixel == other.bitsPerPixel;
+    }
+};
+
+struct GX2TilingPlanKeyHash
+{
+    size_t operator()(const GX2TilingPlanKey& key) const
+    {
+        const u32 fields[] = {
+            (u32)key.dim, key.width, key.height, key.depth, (u32)key.format, (u32)key.aa,
+            key.use, (u32)key.tileMode, key.swizzle, key.level, key.slice, key.bitsPerPixel
+        };
+
+        u64 hash = 0xCBF29CE484222325ull;
+        for (u32 field : fields)
+            hash = (hash ^ field) * 0x100000001B3ull;
 
-    u32 srcLevelWidth = std::max(src->width >> srcLevel, 1u);
-    u32 srcLevelHeight = std::max(src->height >> srcLevel, 1u);
+        return (size_t)hash;
+    }
+};
+
+static GX2TilingPlanKey GX2MakeTilingPlanKey(const GX2Surface* surf, u32 level, u32 slice, u32 bitsPerPixel)
+{
+    GX2TilingPlanKey key;
+    key.dim = surf->dim;
+    key.width = surf->width;
+    key.height = surf->height;
+    key.depth = surf->depth;
+    key.format = GX2SurfaceFormatToAddrFormat(surf->format);
+    key.aa = surf->aa;
+    key.use = surf->use & (GX2_SURFACE_USE_DEPTH_BUFFER | GX2_SURFACE_USE_SCAN_BUFFER);
+    key.tileMode = surf->tileMode;
+    key.swizzle = surf->swizzle >> 8 & 0xFF;
+    key.level = level;
+    key.slice = slice;
+    key.bitsPerPixel = bitsPerPixel;
+    return key;
+}
+
+// In the thin displayable micro tile layout, every row of 8 elements is
+// stored in 8- or 16-byte pieces, and the rows are grouped as follows:
+//  - 8bpp:  rows (0, 2), (1, 3), (4, 6), (5, 7) each form 16 contiguous bytes
+//  - 16bpp: every row forms 16 contiguous bytes
+//  - 32bpp and above: rows (0, 1), (2, 3), (4, 5), (6, 7) each form contiguous
+//    bytes, interleaving the two rows 16 bytes at a time
+// Groups of rows are contiguous, but not necessarily next to each other
+// (e.g. macro tiled 64bpp and 128bpp surfaces).
+static inline u32 GX2GetDisplayableMicroTileGroup(u32 bytesPerElem, u32 j)
+{
+    switch (bytesPerElem)
+    {
+    case 1:  return (j & 1) | (j >> 1 & 2);
+    case 2:  return j;
+    default: return j >> 1;
+    }
+}
 
-    if (GX2SurfaceIsCompressed(srcFormat))
+static inline u32 GX2GetDisplayableMicroTileGroupOffs(u32 bytesPerElem, u32 i, u32 j)
+{
+    switch (bytesPerElem)
     {
-        srcLevelWidth = DivRoundUp(srcLevelWidth, 4);
-        srcLevelHeight = DivRoundUp(srcLevelHeight, 4);
+    case 1:  return (j >> 1 & 1) * 8 + i;
+    case 2:  return i * 2;
+    default:
+        {
+            const u32 rowOffs = i * bytesPerElem;
+            return (rowOffs & ~15u) * 2 + (j & 1) * 16 + (rowOffs & 15);
+        }
     }
+}
+
+static void GX2DetectMicroTileLayout(GX2TilingPlan* plan)
+{
+    plan->microTileLayout = GX2_MICRO_TILE_LAYOUT_OTHER;
+    if (!plan->hasMicroTileOffs)
+        return;
 
-    u32 dstLevelWidth = std::max(dst->width >> dstLevel, 1u);
-    u32 dstLevelHeight = std::max(dst->height >> dstLevel, 1u);
+    const u32 bytesPerElem = plan->bytesPerElem;
+    const u32* offs = plan->microTileOffs;
 
-    if (GX2SurfaceIsCompressed(dstFormat))
+    bool isRowMajor = true;
+    for (u32 j = 0; j < 8 && isRowMajor; j++)
+        for (u32 i = 0; i < 8 && isRowMajor; i++)
+            isRowMajor = offs[j * 8 + i] == (j * plan->pitch + i) * bytesPerElem;
+
+    if (isRowMajor)
     {
-        dstLevelWidth = DivRoundUp(dstLevelWidth, 4);
-        dstLevelHeight = DivRoundUp(dstLevelHeight, 4);
+        plan->microTileLayout = GX2_MICRO_TILE_LAYOUT_ROW_MAJOR;
+        return;
     }
 
-    uintptr_t pSrcImageData;
-    uintptr_t pDstImageData;
+    if (bytesPerElem != 1 && bytesPerElem != 2 && bytesPerElem != 4 &&
+        bytesPerElem != 8 && bytesPerElem != 16)
+        return;
 
-    if (srcLevel == 0)
-        pSrcImageData = (uintptr_t)src->imagePtr;
+    u32 groupsSeen = 0;
 
-    else
+    for (u32 j = 0; j < 8; j++)
     {
-        pSrcImageData = (uintptr_t)src->mipPtr;
-        if (srcLevel != 1)
-            pSrcImageData += src->mipOffset[srcLevel - 1];
+        const u32 group = GX2GetDisplayableMicroTileGroup(bytesPerElem, j);
+        const u32 groupOffs = offs[j * 8] - GX2GetDisplayableMicroTileGroupOffs(bytesPerElem, 0, j);
+
+        for (u32 i = 0; i < 8; i++)
+            if (offs[j * 8 + i] != groupOffs + GX2GetDisplayableMicroTileGroupOffs(bytesPerElem, i, j))
+                return;
+
+        if (groupsSeen & 1 << group)
+        {
+            if (plan->microTileGroupOffs[group] != groupOffs)
+                return;
+        }
+        else
+        {
+            plan->microTileGroupOffs[group] = groupOffs;
+            groupsSeen |= 1 << group;
+        }
     }
 
-    if (dstLevel == 0)
-        pDstImageData = (uintptr_t)dst->imagePtr;
+    plan->microTileLayout = GX2_MICRO_TILE_LAYOUT_DISPLAYABLE;
+}
 
-    else
+static void GX2ComputeMicroTileRuns(GX2TilingPlan* plan)
+{
+    plan->numMicroTileRuns = 0;
+    if (!plan->hasMicroTileOffs)
+        return;
+
+    u32 offs[64];
+    std::memcpy(offs, plan->microTileOffs, sizeof(offs));
+    std::sort(offs, offs + 64);
+
+    for (u32 k = 0; k < 64; k++)
+    {
+        const u32 n = plan->numMicroTileRuns;
+        if (n != 0 && plan->microTileRunOffs[n - 1] + plan->microTileRunSizes[n - 1] == offs[k])
+        {
+            plan->microTileRunSizes[n - 1] += plan->bytesPerElem;
+        }
+        else
+        {
+            plan->microTileRunOffs[n] = offs[k];
+            plan->microTileRunSizes[n] = plan->bytesPerElem;
+            plan->numMicroTileRuns++;
+        }
+    }
+}
+
+// Without micro tile addresses, the cost of building a plan does not
+// depend on the size of the level
+static std::shared_ptr<GX2TilingPlan> GX2BuildTilingPlan(const GX2Surface* surf, u32 level, u32 slice, u32 bitsPerPixel,
+                                                         bool computeMicroTileAddrs = true)
+{
+    std::shared_ptr<GX2TilingPlan> plan = std::make_shared<GX2TilingPlan>();
+
+    ADDR_COMPUTE_SURFACE_INFO_OUTPUT surfInfo;
+    GX2ComputeLevelSurfaceInfo(surf, level, &surfInfo);
+
+    u32 levelWidth = std::max(surf->width >> level, 1u);
+    u32 levelHeight = std::max(surf->height >> level, 1u);
+
+    if (GX2SurfaceIsCompressed(surf->format))
+    {
+        levelWidth = DivRoundUp(levelWidth, 4);
+        levelHeight = DivRoundUp(levelHeight, 4);
+    }
+
+    plan->width = levelWidth;
+    plan->height = levelHeight;
+    plan->pitch = surfInfo.pitch;
+    plan->bytesPerElem = bitsPerPixel / 8;
+    plan->sliceOffs = slice * surfInfo.pitch * levelHeight;
+    plan->linearSpecial = surf->tileMode == GX2_TILE_MODE_LINEAR_SPECIAL;
+
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn = &plan->addrFromCoordIn;
+    std::memset(pIn, 0, sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT));
+
+    pIn->size = sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT);
+    pIn->slice = slice;
+    pIn->sample = 0;
+    pIn->bpp = bitsPerPixel;
+    pIn->pitch = surfInfo.pitch;
+    pIn->height = surfInfo.height;
+    pIn->numSlices = std::max(surfInfo.depth, 1u);
+    pIn->numSamples = 1 << surf->aa;
+    pIn->tileMode = surfInfo.tileMode;
+    pIn->isDepth = surf->use & GX2_SURFACE_USE_DEPTH_BUFFER;
+    pIn->tileBase = 0;
+    pIn->compBits = 0;
+
+    R600AddrLib::ExtractBankPipeSwizzle(surf->swizzle >> 8 & 0xFF,
+                                        &pIn->bankSwizzle,
+                                        &pIn->pipeSwizzle);
+
+    plan->addrFromCoordFunc = AddrGetSurfaceAddrFromCoordFunc(pIn);
+
+    plan->hasMicroTileOffs =
+        AddrComputeSurfaceMicroTileOffsets(pIn, plan->microTileOffs) == ADDR_OK;
+
+    plan->microTilesPerRow = DivRoundUp(levelWidth, 8);
+
+    if (plan->hasMicroTileOffs && computeMicroTileAddrs)
+    {
+        const u32 microTilesPerCol = DivRoundUp(levelHeight, 8);
+        plan->microTileAddrs.resize((size_t)plan->microTilesPerRow * microTilesPerCol);
+
+        u32* pMicroTileAddr = plan->microTileAddrs.data();
+        for (u32 y = 0; y < levelHeight; y += 8)
+            for (u32 x = 0; x < levelWidth; x += 8)
+                *pMicroTileAddr++ = GX2ComputeTilingPlanElemAddr(plan.get(), x, y);
+    }
+
+    GX2DetectMicroTileLayout(plan.get());
+    GX2ComputeMicroTileRuns(plan.get());
+
+    return plan;
+}
+
+// Bounded LRU cache of tiling plans.
+// Pinned plans are kept outside of the LRU and never evicted.
+class GX2TilingPlanCache
+{
+public:
+    GX2TilingPlanCache()
+        : mMaxSize(16 * 1024 * 1024)
+        , mSize(0)
+    {
+    }
+
+    std::shared_ptr<const GX2TilingPlan> get(const GX2Surface* surf, u32 level, u32 slice, u32 bitsPerPixel, bool pin = false)
+    {
+        const GX2TilingPlanKey key = GX2MakeTilingPlanKey(surf, level, slice, bitsPerPixel);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            const auto& it_pinned = mPinned.find(key);
+            if (it_pinned != mPinned.end())
+                return it_pinned->second;
+
+            const auto& it = mEntries.find(key);
+            if (it != mEntries.end())
+            {
+                std::shared_ptr<const GX2TilingPlan> plan = it->second->second;
+                if (pin)
+                {
+                    mPinned.emplace(key, plan);
+                    erase(it);
+                }
+                else
+                {
+                    mLRU.splice(mLRU.begin(), mLRU, it->second);
+                }
+                return plan;
+            }
+        }
+
+        // Build outside of the lock, other threads might be doing the same
+        // for different keys
+        std::shared_ptr<const GX2TilingPlan> plan = GX2BuildTilingPlan(surf, level, slice, bitsPerPixel);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (pin)
+        {
+            const auto& it = mEntries.find(key);
+            if (it != mEntries.end())
+                erase(it);
+
+            return mPinned.emplace(key, plan).first->second;
+        }
+
+        if (mPinned.count(key) != 0 || mEntries.count(key) != 0)
+            return plan;
+
+        const size_t planSize = plan->byteSize();
+        if (planSize > mMaxSize)
+            return plan;
+
+        mLRU.emplace_front(key, plan);
+        mEntries.emplace(key, mLRU.begin());
+        mSize += planSize;
+
+        trim();
+        return plan;
+    }
+
+    void setMaxSize(size_t maxSize)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxSize = maxSize;
+        trim();
+    }
+
+    void clear(bool unpin)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLRU.clear();
+        mEntries.clear();
+        mSize = 0;
+
+        if (unpin)
+            mPinned.clear();
+    }
+
+private:
+    typedef std::list< std::pair< GX2TilingPlanKey, std::shared_ptr<const GX2TilingPlan> > > LRUList;
+    typedef std::unordered_map<GX2TilingPlanKey, LRUList::iterator, GX2TilingPlanKeyHash> EntryMap;
+
+    void erase(EntryMap::iterator it)
+    {
+        mSize -= it->second->second->byteSize();
+        mLRU.erase(it->second);
+        mEntries.erase(it);
+    }
+
+    void trim()
+    {
+        while (mSize > mMaxSize && !mLRU.empty())
+            erase(mEntries.find(mLRU.back().first));
+    }
+
+    std::mutex mMutex;
+    size_t mMaxSize;
+    size_t mSize;
+    LRUList mLRU;
+    EntryMap mEntries;
+    std::unordered_map<GX2TilingPlanKey, std::shared_ptr<const GX2TilingPlan>, GX2TilingPlanKeyHash> mPinned;
+};
+
+static GX2TilingPlanCache& GX2GetTilingPlanCache()
+{
+    static GX2TilingPlanCache cache;
+    return cache;
+}
+
+static inline uintptr_t GX2GetSurfaceLevelImageData(const GX2Surface* surf, u32 level)
+{
+    if (level == 0)
+        return (uintptr_t)surf->imagePtr;
+
+    uintptr_t imageData = (uintptr_t)surf->mipPtr;
+    if (level != 1)
+        imageData += surf->mipOffset[level - 1];
+
+    return imageData;
+}
+
+// Number of slices stored in each micro tile
+static inline u32 GX2GetTileModeThickness(AddrTileMode tileMode)
+{
+    switch (tileMode)
     {
-        pDstImageData = (uintptr_t)dst->mipPtr;
-        if (dstLevel != 1)
-            pDstImageData += dst->mipOffset[dstLevel - 1];
+    case ADDR_TM_1D_TILED_THICK:
+    case ADDR_TM_2D_TILED_THICK:
+    case ADDR_TM_2B_TILED_THICK:
+    case ADDR_TM_3D_TILED_THICK:
+    case ADDR_TM_3B_TILED_THICK:
+        return 4;
+    case ADDR_TM_2D_TILED_XTHICK:
+    case ADDR_TM_3D_TILED_XTHICK:
+        return 8;
+    default:
+        return 1;
     }
+}
+
+// Micro tile kernels.
+// Move a full micro tile between the thin displayable layout (see above)
+// and a row-major layout with the given pitch, in bytes.
+// All the permutations are done on 8-byte pieces at least, so they only
+// consist of loads and stores (and 128-bit lane shuffles for AVX2).
+typedef void (*GX2MicroTileKernel)(u8* pTiled, const u32* groupOffs, u8* pLinear, u32 linearPitch);
+
+template <bool toTiled, u32 size>
+static inline void GX2MoveMicroTileBytes_Generic(u8* pTiled, u8* pLinear)
+{
+    if (toTiled)
+        std::memcpy(pTiled, pLinear, size);
+    else
+        std::memcpy(pLinear, pTiled, size);
+}
 
-    u32 srcSliceOffs = srcSlice * srcAddrSurfInfo.pitch * srcLevelHeight;
-    u32 dstSliceOffs = dstSlice * dstAddrSurfInfo.pitch * dstLevelHeight;
+template <u32 bytesPerElem, bool toTiled>
+static void GX2MoveMicroTile_Generic(u8* pTiled, const u32* groupOffs, u8* pLinear, u32 linearPitch)
+{
+    if (bytesPerElem == 1)
+    {
+        for (u32 group = 0; group < 4; group++)
+        {
+            u8* pGroup = pTiled + groupOffs[group];
+            u8* pRow0 = pLinear + ((group & 1) | (group & 2) << 1) * linearPitch;
+            u8* pRow1 = pRow0 + 2 * linearPitch;
 
-    for (u32 y = 0; y < dstLevelHeight; y++)
+            GX2MoveMicroTileBytes_Generic<toTiled, 8>(pGroup,     pRow0);
+            GX2MoveMicroTileBytes_Generic<toTiled, 8>(pGroup + 8, pRow1);
+        }
+    }
+    else if (bytesPerElem == 2)
+    {
+        for (u32 j = 0; j < 8; j++)
+            GX2MoveMicroTileBytes_Generic<toTiled, 16>(pTiled + groupOffs[j], pLinear + j * linearPitch);
+    }
+    else
     {
-        for (u32 x = 0; x < dstLevelWidth; x++)
+        for (u32 group = 0; group < 4; group++)
         {
-            srcAddrFromCoordIn.x = (x * srcLevelWidth) / dstLevelWidth;
-            srcAddrFromCoordIn.y = (y * srcLevelHeight) / dstLevelHeight;
-            dstAddrFromCoordIn.x = x;
-            dstAddrFromCoordIn.y = y;
+            u8* pGroup = pTiled + groupOffs[group];
+            u8* pRow0 = pLinear + group * 2 * linearPitch;
+            u8* pRow1 = pRow0 + linearPitch;
+
+            for (u32 offs = 0; offs < bytesPerElem * 8; offs += 16)
+            {
+                GX2MoveMicroTileBytes_Generic<toTiled, 16>(pGroup + offs * 2,      pRow0 + offs);
+                GX2MoveMicroTileBytes_Generic<toTiled, 16>(pGroup + offs * 2 + 16, pRow1 + offs);
+            }
+        }
+    }
+}
+
+#if defined(GX2_MICRO_TILE_KERNELS_X86)
 
-            if (src->tileMode == GX2_TILE_MODE_LINEAR_SPECIAL)
-                srcAddrFromCoordOut.addr = (srcSliceOffs + y * srcAddrSurfInfo.pitch + x) * bytesPerPixel;
+template <bool toTiled>
+static inline void GX2MoveMicroTileBytes_SSE2(u8* pTiled, u8* pLinear)
+{
+    if (toTiled)
+        _mm_storeu_si128((__m128i*)pTiled, _mm_loadu_si128((const __m128i*)pLinear));
+    else
+        _mm_storeu_si128((__m128i*)pLinear, _mm_loadu_si128((const __m128i*)pTiled));
+}
+
+template <u32 bytesPerElem, bool toTiled>
+static void GX2MoveMicroTile_SSE2(u8* pTiled, const u32* groupOffs, u8* pLinear, u32 linearPitch)
+{
+    if (bytesPerElem == 1)
+    {
+        for (u32 group = 0; group < 4; group++)
+        {
+            u8* pGroup = pTiled + groupOffs[group];
+            u8* pRow0 = pLinear + ((group & 1) | (group & 2) << 1) * linearPitch;
+            u8* pRow1 = pRow0 + 2 * linearPitch;
 
+            if (toTiled)
+            {
+                const __m128i row0 = _mm_loadl_epi64((const __m128i*)pRow0);
+                const __m128i row1 = _mm_loadl_epi64((const __m128i*)pRow1);
+                _mm_storeu_si128((__m128i*)pGroup, _mm_unpacklo_epi64(row0, row1));
+            }
             else
-                AddrComputeSurfaceAddrFromCoord(&srcAddrFromCoordIn, &srcAddrFromCoordOut);
+            {
+                const __m128i rows = _mm_loadu_si128((const __m128i*)pGroup);
+                _mm_storel_epi64((__m128i*)pRow0, rows);
+                _mm_storel_epi64((__m128i*)pRow1, _mm_unpackhi_epi64(rows, rows));
+            }
+        }
+    }
+    else if (bytesPerElem == 2)
+    {
+        for (u32 j = 0; j < 8; j++)
+            GX2MoveMicroTileBytes_SSE2<toTiled>(pTiled + groupOffs[j], pLinear + j * linearPitch);
+    }
+    else
+    {
+        for (u32 group = 0; group < 4; group++)
+        {
+            u8* pGroup = pTiled + groupOffs[group];
+            u8* pRow0 = pLinear + group * 2 * linearPitch;
+            u8* pRow1 = pRow0 + linearPitch;
+
+            for (u32 offs = 0; offs < bytesPerElem * 8; offs += 16)
+            {
+                GX2MoveMicroTileBytes_SSE2<toTiled>(pGroup + offs * 2,      pRow0 + offs);
+                GX2MoveMicroTileBytes_SSE2<toTiled>(pGroup + offs * 2 + 16, pRow1 + offs);
+            }
+        }
+    }
+}
 
-            if (dst->tileMode == GX2_TILE_MODE_LINEAR_SPECIAL)
-                dstAddrFromCoordOut.addr = (dstSliceOffs + y * dstAddrSurfInfo.pitch + x) * bytesPerPixel;
+// 32 bytes of two rows at a time: (row0.lo, row0.hi), (row1.lo, row1.hi)
+// <-> (row0.lo, row1.lo), (row0.hi, row1.hi)
+template <u32 bytesPerElem, bool toTiled>
+static CPU_FEATURES_TARGET_AVX2 void GX2MoveMicroTile_AVX2(u8* pTiled, const u32* groupOffs, u8* pLinear, u32 linearPitch)
+{
+    if (bytesPerElem < 4)
+    {
+        GX2MoveMicroTile_SSE2<bytesPerElem, toTiled>(pTiled, groupOffs, pLinear, linearPitch);
+        return;
+    }
+
+    for (u32 group = 0; group < 4; group++)
+    {
+        u8* pGroup = pTiled + groupOffs[group];
+        u8* pRow0 = pLinear + group * 2 * linearPitch;
+        u8* pRow1 = pRow0 + linearPitch;
 
+        for (u32 offs = 0; offs < bytesPerElem * 8; offs += 32)
+        {
+            if (toTiled)
+            {
+                const __m256i row0 = _mm256_loadu_si256((const __m256i*)(pRow0 + offs));
+                const __m256i row1 = _mm256_loadu_si256((const __m256i*)(pRow1 + offs));
+                _mm256_storeu_si256((__m256i*)(pGroup + offs * 2),      _mm256_permute2x128_si256(row0, row1, 0x20));
+                _mm256_storeu_si256((__m256i*)(pGroup + offs * 2 + 32), _mm256_permute2x128_si256(row0, row1, 0x31));
+            }
             else
-                AddrComputeSurfaceAddrFromCoord(&dstAddrFromCoordIn, &dstAddrFromCoordOut);
+            {
+                const __m256i lo = _mm256_loadu_si256((const __m256i*)(pGroup + offs * 2));
+                const __m256i hi = _mm256_loadu_si256((const __m256i*)(pGroup + offs * 2 + 32));
+                _mm256_storeu_si256((__m256i*)(pRow0 + offs), _mm256_permute2x128_si256(lo, hi, 0x20));
+                _mm256_storeu_si256((__m256i*)(pRow1 + offs), _mm256_permute2x128_si256(lo, hi, 0x31));
+            }
+        }
+    }
+}
+
+#elif defined(GX2_MICRO_TILE_KERNELS_NEON)
+
+template <bool toTiled>
+static inline void GX2MoveMicroTileBytes_NEON(u8* pTiled, u8* pLinear)
+{
+    if (toTiled)
+        vst1q_u8(pTiled, vld1q_u8(pLinear));
+    else
+        vst1q_u8(pLinear, vld1q_u8(pTiled));
+}
+
+template <u32 bytesPerElem, bool toTiled>
+static void GX2MoveMicroTile_NEON(u8* pTiled, const u32* groupOffs, u8* pLinear, u32 linearPitch)
+{
+    if (bytesPerElem == 1)
+    {
+        for (u32 group = 0; group < 4; group++)
+        {
+            u8* pGroup = pTiled + groupOffs[group];
+            u8* pRow0 = pLinear + ((group & 1) | (group & 2) << 1) * linearPitch;
+            u8* pRow1 = pRow0 + 2 * linearPitch;
 
-            uintptr_t pSrcPixel = pSrcImageData + (u32)srcAddrFromCoordOut.addr;
-            uintptr_t pDstPixel = pDstImageData + (u32)dstAddrFromCoordOut.addr;
+            if (toTiled)
+            {
+                vst1q_u8(pGroup, vcombine_u8(vld1_u8(pRow0), vld1_u8(pRow1)));
+            }
+            else
+            {
+                const uint8x16_t rows = vld1q_u8(pGroup);
+                vst1_u8(pRow0, vget_low_u8(rows));
+                vst1_u8(pRow1, vget_high_u8(rows));
+            }
+        }
+    }
+    else if (bytesPerElem == 2)
+    {
+        for (u32 j = 0; j < 8; j++)
+            GX2MoveMicroTileBytes_NEON<toTiled>(pTiled + groupOffs[j], pLinear + j * linearPitch);
+    }
+    else
+    {
+        for (u32 group = 0; group < 4; group++)
+        {
+            u8* pGroup = pTiled + groupOffs[group];
+            u8* pRow0 = pLinear + group * 2 * linearPitch;
+            u8* pRow1 = pRow0 + linearPitch;
 
-            switch (bitsPerPixel)
+            for (u32 offs = 0; offs < bytesPerElem * 8; offs += 16)
             {
-            case 128: *((u64*)pDstPixel + 1) = *((u64*)pSrcPixel + 1);
-                [[fallthrough]];
-            case 64:  *(u64*)pDstPixel = *(u64*)pSrcPixel; break;
-            case 32:  *(u32*)pDstPixel = *(u32*)pSrcPixel; break;
-            case 16:  *(u16*)pDstPixel = *(u16*)pSrcPixel; break;
-            case 8 :  *(u8 *)pDstPixel = *(u8 *)pSrcPixel; break;
+                GX2MoveMicroTileBytes_NEON<toTiled>(pGroup + offs * 2,      pRow0 + offs);
+                GX2MoveMicroTileBytes_NEON<toTiled>(pGroup + offs * 2 + 16, pRow1 + offs);
             }
         }
     }
 }
 
+#endif
+
+template <u32 bytesPerElem, bool toTiled>
+static GX2MicroTileKernel GX2SelectMicroTileKernel()
+{
+    const u32 features = CPUFeatures_Get();
+    (void)features;
+
+#if defined(GX2_MICRO_TILE_KERNELS_X86)
+    if (features & CPU_FEATURE_AVX2)
+        return GX2MoveMicroTile_AVX2<bytesPerElem, toTiled>;
+
+    if (features & CPU_FEATURE_SSE2)
+        return GX2MoveMicroTile_SSE2<bytesPerElem, toTiled>;
+#elif defined(GX2_MICRO_TILE_KERNELS_NEON)
+    if (features & CPU_FEATURE_NEON)
+        return GX2MoveMicroTile_NEON<bytesPerElem, toTiled>;
+#endif
+
+    return GX2MoveMicroTile_Generic<bytesPerElem, toTiled>;
+}
+
+// How the full micro tiles of a copy between two levels of the same size
+// are moved at once, if possible
+struct GX2MicroTileCopy
+{
+    // Micro tiles with the same layout in src and dst (e.g. macro tiled
+    // surfaces of different tile modes or swizzles) are copied run by run
+    bool sameLayout;
+
+    // Micro tiles going from a linear surface to a surface with thin
+    // displayable micro tiles (or the other way around) are moved by kernels
+    GX2MicroTileKernel kernel;
+    bool toTiled;
+};
+
+template <u32 bytesPerElem>
+static GX2MicroTileCopy GX2SelectMicroTileCopy(const GX2TilingPlan* pSrc, const GX2TilingPlan* pDst)
+{
+    GX2MicroTileCopy tileCopy = { false, nullptr, false };
+
+    if (pSrc->width != pDst->width || pSrc->height != pDst->height ||
+        !pSrc->hasMicroTileOffs || !pDst->hasMicroTileOffs)
+        return tileCopy;
+
+    if (std::memcmp(pSrc->microTileOffs, pDst->microTileOffs, sizeof(pSrc->microTileOffs)) == 0)
+    {
+        tileCopy.sameLayout = true;
+    }
+    else if (pSrc->microTileLayout == GX2_MICRO_TILE_LAYOUT_ROW_MAJOR &&
+             pDst->microTileLayout == GX2_MICRO_TILE_LAYOUT_DISPLAYABLE)
+    {
+        tileCopy.kernel = GX2SelectMicroTileKernel<bytesPerElem, true>();
+        tileCopy.toTiled = true;
+    }
+    else if (pSrc->microTileLayout == GX2_MICRO_TILE_LAYOUT_DISPLAYABLE &&
+             pDst->microTileLayout == GX2_MICRO_TILE_LAYOUT_ROW_MAJOR)
+    {
+        tileCopy.kernel = GX2SelectMicroTileKernel<bytesPerElem, false>();
+    }
+
+    return tileCopy;
+}
+
+// Copies the destination micro tile whose origin is (tileX, tileY).
+// Without resampling, src and dst levels have the same dimensions and
+// element (x, y) of dst comes from element (x, y) of src; otherwise, it
+// comes from the nearest element of src, which costs two divisions.
+template <u32 bytesPerElem, bool resample>
+static inline void GX2CopySurfaceMicroTile(const GX2TilingPlan* pSrc, uintptr_t pSrcImageData,
+                                           const GX2TilingPlan* pDst, uintptr_t pDstImageData,
+                                           const GX2MicroTileCopy& tileCopy,
+                                           u32 tileX, u32 tileY)
+{
+    const u32 srcLevelWidth = pSrc->width;
+    const u32 srcLevelHeight = pSrc->height;
+    const u32 dstLevelWidth = pDst->width;
+    const u32 dstLevelHeight = pDst->height;
+
+    const u32 tileWidth = std::min(dstLevelWidth - tileX, 8u);
+    const u32 tileHeight = std::min(dstLevelHeight - tileY, 8u);
+    const u32 microTileIdx = (tileY / 8) * pDst->microTilesPerRow + tileX / 8;
+
+    uintptr_t pDstTile = 0;
+    if (pDst->hasMicroTileOffs)
+        pDstTile = pDstImageData + pDst->microTileAddrs[microTileIdx];
+
+    uintptr_t pSrcTile = 0;
+    if (!resample && pSrc->hasMicroTileOffs)
+        pSrcTile = pSrcImageData + pSrc->microTileAddrs[microTileIdx];
+
+    if (!resample && tileWidth == 8 && tileHeight == 8)
+    {
+        if (tileCopy.sameLayout)
+        {
+            for (u32 k = 0; k < pDst->numMicroTileRuns; k++)
+                std::memcpy((void*)(pDstTile + pDst->microTileRunOffs[k]),
+                            (const void*)(pSrcTile + pDst->microTileRunOffs[k]),
+                            pDst->microTileRunSizes[k]);
+            return;
+        }
+
+        if (tileCopy.kernel)
+        {
+            if (tileCopy.toTiled)
+                tileCopy.kernel((u8*)pDstTile, pDst->microTileGroupOffs, (u8*)pSrcTile, pSrc->pitch * bytesPerElem);
+            else
+                tileCopy.kernel((u8*)pSrcTile, pSrc->microTileGroupOffs, (u8*)pDstTile, pDst->pitch * bytesPerElem);
+
+            return;
+        }
+    }
+
+    for (u32 j = 0; j < tileHeight; j++)
+    {
+        const u32 y = tileY + j;
+        const u32 srcY = resample ? (y * srcLevelHeight) / dstLevelHeight : y;
+
+        for (u32 i = 0; i < tileWidth; i++)
+        {
+            const u32 x = tileX + i;
+            const u32 srcX = resample ? (x * srcLevelWidth) / dstLevelWidth : x;
+
+            uintptr_t pSrcElem;
+            if (!resample && pSrc->hasMicroTileOffs)
+                pSrcElem = pSrcTile + pSrc->microTileOffs[j * 8 + i];
+
+            else if (pSrc->hasMicroTileOffs)
+                pSrcElem = pSrcImageData + pSrc->microTileAddrs[(srcY / 8) * pSrc->microTilesPerRow + srcX / 8]
+                                         + pSrc->microTileOffs[(srcY & 7) * 8 + (srcX & 7)];
+
+            else
+                pSrcElem = pSrcImageData + GX2ComputeTilingPlanElemAddr(pSrc, srcX, srcY);
+
+            uintptr_t pDstElem;
+            if (pDst->hasMicroTileOffs)
+                pDstElem = pDstTile + pDst->microTileOffs[j * 8 + i];
+
+            else
+                pDstElem = pDstImageData + GX2ComputeTilingPlanElemAddr(pDst, x, y);
+
+            std::memcpy((void*)pDstElem, (const void*)pSrcElem, bytesPerElem);
+        }
+    }
+}
+
+template <u32 bytesPerElem>
+static void GX2CopySurfaceLevel(const GX2TilingPlan* pSrc, uintptr_t pSrcImageData,
+                                const GX2TilingPlan* pDst, uintptr_t pDstImageData,
+                                u32 tileRowBegin, u32 tileRowEnd)
+{
+    const u32 tileYEnd = std::min(tileRowEnd * 8, pDst->height);
+
+    const GX2MicroTileCopy tileCopy = GX2SelectMicroTileCopy<bytesPerElem>(pSrc, pDst);
+
+    if (pSrc->width != pDst->width || pSrc->height != pDst->height)
+    {
+        for (u32 tileY = tileRowBegin * 8; tileY < tileYEnd; tileY += 8)
+            for (u32 tileX = 0; tileX < pDst->width; tileX += 8)
+                GX2CopySurfaceMicroTile<bytesPerElem, true>(pSrc, pSrcImageData, pDst, pDstImageData,
+                                                            tileCopy, tileX, tileY);
+        return;
+    }
+
+    for (u32 tileY = tileRowBegin * 8; tileY < tileYEnd; tileY += 8)
+        for (u32 tileX = 0; tileX < pDst->width; tileX += 8)
+            GX2CopySurfaceMicroTile<bytesPerElem, false>(pSrc, pSrcImageData, pDst, pDstImageData,
+                                                         tileCopy, tileX, tileY);
+}
+
+// Same as GX2CopySurfaceLevel over the whole level, except that the source
+// is read in increasing address order: the source addresses of the slice
+// are walked front to back and mapped back to the micro tile they belong
+// to. Micro tiles stored as a single run of bytes are copied whole when
+// encountered. Other micro tiles (e.g. those of 64 and 128 bpp macro tiled
+// surfaces, split into 256-byte pieces 2048 bytes apart, or those of thick
+// tile modes, interleaved with the other slices) are copied one piece at a
+// time, scattering the elements of each piece
+template <u32 bytesPerElem>
+static void GX2CopySurfaceLevelSequentialRead(const GX2TilingPlan* pSrc, uintptr_t pSrcImageData,
+                                              const GX2TilingPlan* pDst, uintptr_t pDstImageData)
+{
+    assert(pSrc->width == pDst->width && pSrc->height == pDst->height);
+
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT& surfIn = pSrc->addrFromCoordIn;
+
+    // Linear sources are already read row by row
+    if (pSrc->linearSpecial || surfIn.tileMode <= ADDR_TM_LINEAR_ALIGNED)
+    {
+        GX2CopySurfaceLevel<bytesPerElem>(pSrc, pSrcImageData, pDst, pDstImageData,
+                                          0, DivRoundUp(pDst->height, 8));
+        return;
+    }
+
+    const GX2MicroTileCopy tileCopy = GX2SelectMicroTileCopy<bytesPerElem>(pSrc, pDst);
+
+    ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT coordFromAddrIn;
+    std::memset(&coordFromAddrIn, 0, sizeof(ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT));
+
+    coordFromAddrIn.size = sizeof(ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT);
+    coordFromAddrIn.bpp = surfIn.bpp;
+    coordFromAddrIn.pitch = surfIn.pitch;
+    coordFromAddrIn.height = surfIn.height;
+    coordFromAddrIn.numSlices = surfIn.numSlices;
+    coordFromAddrIn.numSamples = surfIn.numSamples;
+    coordFromAddrIn.tileMode = surfIn.tileMode;
+    coordFromAddrIn.isDepth = surfIn.isDepth;
+    coordFromAddrIn.tileBase = surfIn.tileBase;
+    coordFromAddrIn.compBits = surfIn.compBits;
+    coordFromAddrIn.pipeSwizzle = surfIn.pipeSwizzle;
+    coordFromAddrIn.bankSwizzle = surfIn.bankSwizzle;
+
+    ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT coordFromAddrOut;
+    coordFromAddrOut.size = sizeof(ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT);
+
+    const u32 thickness = GX2GetTileModeThickness(surfIn.tileMode);
+
+    const u64 sliceBytes = (u64)surfIn.pitch * surfIn.height * thickness * surfIn.numSamples * bytesPerElem;
+    const u64 sliceBegin = (surfIn.slice / thickness) * sliceBytes;
+    const u64 sliceEnd = sliceBegin + sliceBytes;
+
+    // Every run of this many bytes lies within a single micro tile
+    // (or a single 256-byte piece of a micro tile)
+    const u32 step = std::min(64 * bytesPerElem, 256u);
+
+    // Elements of a micro tile in increasing source address order
+    u32 elemOrder[64];
+    for (u32 k = 0; k < 64; k++)
+        elemOrder[k] = k;
+
+    if (pSrc->hasMicroTileOffs)
+        std::sort(elemOrder, elemOrder + 64,
+                  [pSrc](u32 a, u32 b) { return pSrc->microTileOffs[a] < pSrc->microTileOffs[b]; });
+
+    // Whether the bytes of every micro tile of the slice are contiguous and
+    // read by a single step
+    const bool wholeMicroTiles = pSrc->hasMicroTileOffs && 64 * bytesPerElem <= step &&
+                                 pSrc->microTileOffs[elemOrder[63]] - pSrc->microTileOffs[elemOrder[0]] ==
+                                 63 * bytesPerElem;
+
+    // Runs of elements of a micro tile contiguous in both src and dst, in
+    // increasing source address order
+    const bool copyRuns = pSrc->hasMicroTileOffs && pDst->hasMicroTileOffs;
+
+    u32 numRuns = 0;
+    u32 runSrcOffs[64];
+    u32 runSrcEndOffs[64];
+    u32 runDstOffs[64];
+
+    if (copyRuns)
+    {
+        for (u32 k = 0; k < 64; k++)
+        {
+            const u32 srcOffs = pSrc->microTileOffs[elemOrder[k]];
+            const u32 dstOffs = pDst->microTileOffs[elemOrder[k]];
+
+            if (numRuns != 0 && runSrcEndOffs[numRuns - 1] == srcOffs &&
+                runDstOffs[numRuns - 1] + (srcOffs - runSrcOffs[numRuns - 1]) == dstOffs)
+            {
+                runSrcEndOffs[numRuns - 1] += bytesPerElem;
+            }
+            else
+            {
+                runSrcOffs[numRuns] = srcOffs;
+                runSrcEndOffs[numRuns] = srcOffs + bytesPerElem;
+                runDstOffs[numRuns] = dstOffs;
+                numRuns++;
+            }
+        }
+    }
+
+    const u32 microTilesPerCol = DivRoundUp(pDst->height, 8);
+    std::vector<bool> visited((size_t)pDst->microTilesPerRow * microTilesPerCol, false);
+
+    for (u64 addr = sliceBegin; addr < sliceEnd; addr += step)
+    {
+        coordFromAddrIn.addr = addr;
+        AddrComputeSurfaceCoordFromAddr(&coordFromAddrIn, &coordFromAddrOut);
+
+        // Elements of a micro tile crossing the edge of the level might be
+        // read by a step starting beyond the edge
+        const u32 tileX = coordFromAddrOut.x & ~7u;
+        const u32 tileY = coordFromAddrOut.y & ~7u;
+        if (tileX >= pDst->width || tileY >= pDst->height)
+            continue;
+
+        const size_t microTileIdx = (size_t)(tileY / 8) * pDst->microTilesPerRow + tileX / 8;
+
+        if (wholeMicroTiles)
+        {
+            if (coordFromAddrOut.slice != surfIn.slice || coordFromAddrOut.sample != 0 || visited[microTileIdx])
+                continue;
+
+            visited[microTileIdx] = true;
+            GX2CopySurfaceMicroTile<bytesPerElem, false>(pSrc, pSrcImageData, pDst, pDstImageData, tileCopy,
+                                                         tileX, tileY);
+            continue;
+        }
+
+        // Copy the elements of the micro tile (of the slice, sample 0) read
+        // by this step only. The step might belong to another slice or
+        // sample and hold none of them.
+        const u32 tileWidth = std::min(pDst->width - tileX, 8u);
+        const u32 tileHeight = std::min(pDst->height - tileY, 8u);
+
+        if (copyRuns && tileWidth == 8 && tileHeight == 8)
+        {
+            const u64 srcTileAddr = pSrc->microTileAddrs[microTileIdx];
+            const uintptr_t pDstTile = pDstImageData + pDst->microTileAddrs[microTileIdx];
+
+            // First run ending within the step
+            const u32 stepOffs = (u32)(std::max(addr, srcTileAddr) - srcTileAddr);
+            u32 r = (u32)(std::upper_bound(runSrcEndOffs, runSrcEndOffs + numRuns, stepOffs) - runSrcEndOffs);
+
+            for (; r < numRuns && srcTileAddr + runSrcOffs[r] < addr + step; r++)
+            {
+                // Part of the run within the step
+                const u64 runBegin = std::max(srcTileAddr + runSrcOffs[r], addr);
+                const u64 runEnd = std::min(srcTileAddr + runSrcEndOffs[r], addr + step);
+
+                std::memcpy((void*)(pDstTile + runDstOffs[r] + (runBegin - srcTileAddr - runSrcOffs[r])),
+                            (const void*)(pSrcImageData + runBegin), runEnd - runBegin);
+            }
+
+            continue;
+        }
+
+        u32 k = 0;
+        u64 tileAddr = 0;
+
+        if (pSrc->hasMicroTileOffs)
+        {
+            // Skip to the first element of the step
+            tileAddr = pSrc->microTileAddrs[microTileIdx];
+            while (k < 64 && tileAddr + pSrc->microTileOffs[elemOrder[k]] < addr)
+                k++;
+        }
+
+        for (; k < 64; k++)
+        {
+            const u32 i = elemOrder[k] & 7;
+            const u32 j = elemOrder[k] >> 3;
+
+            u64 srcAddr;
+            if (pSrc->hasMicroTileOffs)
+            {
+                srcAddr = tileAddr + pSrc->microTileOffs[elemOrder[k]];
+                if (srcAddr >= addr + step)
+                    break;
+            }
+            else
+            {
+                if (i >= tileWidth || j >= tileHeight)
+                    continue;
+
+                srcAddr = GX2ComputeTilingPlanElemAddr(pSrc, tileX + i, tileY + j);
+                if (srcAddr < addr || srcAddr >= addr + step)
+                    continue;
+            }
+
+            if (i >= tileWidth || j >= tileHeight)
+                continue;
+
+            uintptr_t pDstElem;
+            if (pDst->hasMicroTileOffs)
+                pDstElem = pDstImageData + pDst->microTileAddrs[microTileIdx] + pDst->microTileOffs[j * 8 + i];
+            else
+                pDstElem = pDstImageData + GX2ComputeTilingPlanElemAddr(pDst, tileX + i, tileY + j);
+
+            std::memcpy((void*)pDstElem, (const void*)(pSrcImageData + srcAddr), bytesPerElem);
+        }
+    }
+}
+
+// Moves one level of src to dst, which only differs from src by its bank
+// and pipe swizzle.
+// Within the bytes of one micro tile slice (which are contiguous), the bank
+// and pipe bits of every address are XORed with the same value when the
+// swizzle changes, so every block of 8 groups of 256 bytes (2 pipes times
+// 4 banks) is permuted the same way. The permutation is found by addressing
+// the first element of the slice with both swizzles.
+static void GX2RebaseSurfaceLevelSwizzle(const GX2Surface* src, GX2Surface* dst, u32 level)
+{
+    ADDR_COMPUTE_SURFACE_INFO_OUTPUT surfInfo;
+    GX2ComputeLevelSurfaceInfo(src, level, &surfInfo);
+
+    const u8* pSrcImageData = (const u8*)GX2GetSurfaceLevelImageData(src, level);
+    u8* pDstImageData = (u8*)GX2GetSurfaceLevelImageData(dst, level);
+
+    if (surfInfo.tileMode < ADDR_TM_2D_TILED_THIN1)
+    {
+        std::memcpy(pDstImageData, pSrcImageData, (size_t)surfInfo.surfSize);
+        return;
+    }
+
+    const u32 groupSize = 256;
+    const u32 numGroups = 8;
+    const u32 blockSize = groupSize * numGroups;
+
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT srcIn;
+    std::memset(&srcIn, 0, sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT));
+
+    srcIn.size = sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT);
+    srcIn.bpp = surfInfo.bpp;
+    srcIn.pitch = surfInfo.pitch;
+    srcIn.height = surfInfo.height;
+    srcIn.numSlices = std::max(surfInfo.depth, 1u);
+    srcIn.numSamples = 1 << src->aa;
+    srcIn.tileMode = surfInfo.tileMode;
+    srcIn.isDepth = src->use & GX2_SURFACE_USE_DEPTH_BUFFER;
+
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT dstIn = srcIn;
+
+    R600AddrLib::ExtractBankPipeSwizzle(src->swizzle >> 8 & 0xFF,
+                                        &srcIn.bankSwizzle,
+                                        &srcIn.pipeSwizzle);
+
+    R600AddrLib::ExtractBankPipeSwizzle(dst->swizzle >> 8 & 0xFF,
+                                        &dstIn.bankSwizzle,
+                                        &dstIn.pipeSwizzle);
+
+    const u32 thickness = GX2GetTileModeThickness(surfInfo.tileMode);
+    const u64 sliceBytes = (u64)surfInfo.pitch * surfInfo.height * thickness * srcIn.numSamples * surfInfo.bpp / 8;
+    assert(sliceBytes % blockSize == 0 && surfInfo.surfSize % sliceBytes == 0);
+
+    const u32 numTileSlices = (u32)(surfInfo.surfSize / sliceBytes);
+
+    for (u32 tileSlice = 0; tileSlice < numTileSlices; tileSlice++)
+    {
+        ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT srcOut;
+        srcOut.size = sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT);
+
+        ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT dstOut;
+        dstOut.size = sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT);
+
+        srcIn.slice = dstIn.slice = std::min(tileSlice * thickness, srcIn.numSlices - 1);
+        AddrComputeSurfaceAddrFromCoord(&srcIn, &srcOut);
+        AddrComputeSurfaceAddrFromCoord(&dstIn, &dstOut);
+
+        assert(((srcOut.addr ^ dstOut.addr) & ~(u64)(blockSize - groupSize)) == 0);
+        const u32 groupXor = (u32)((srcOut.addr ^ dstOut.addr) / groupSize);
+
+        const u8* pSrc = pSrcImageData + tileSlice * sliceBytes;
+        u8* pDst = pDstImageData + tileSlice * sliceBytes;
+
+        if (groupXor == 0)
+        {
+            std::memcpy(pDst, pSrc, (size_t)sliceBytes);
+            continue;
+        }
+
+        for (u64 block = 0; block < sliceBytes; block += blockSize)
+            for (u32 group = 0; group < numGroups; group++)
+                std::memcpy(pDst + block + (group ^ groupXor) * groupSize,
+                            pSrc + block + group * groupSize,
+                            groupSize);
+    }
+}
+
+// A range of micro tile rows of the destination of a copy.
+// Distinct micro tiles never share bytes, so jobs can run in any order.
+struct GX2CopySurfaceJob
+{
+    std::shared_ptr<const GX2TilingPlan> srcPlan;
+    std::shared_ptr<const GX2TilingPlan> dstPlan;
+    uintptr_t srcImageData;
+    uintptr_t dstImageData;
+    u32 tileRowBegin;
+    u32 tileRowEnd;
+};
+
+// Levels smaller than this are copied by a single job, which also makes
+// copying small surfaces serial
+static const size_t GX2_COPY_SURFACE_MIN_JOB_SIZE = 0x10000;
+
+static void GX2AddCopySurfaceJobs(std::vector<GX2CopySurfaceJob>* jobs,
+                                  const GX2Surface* src, u32 srcLevel, u32 srcSlice,
+                                  const GX2Surface* dst, u32 dstLevel, u32 dstSlice)
+{
+    u32 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(src->format);
+
+    GX2TilingPlanCache& cache = GX2GetTilingPlanCache();
+
+    GX2CopySurfaceJob job;
+    job.srcPlan = cache.get(src, srcLevel, srcSlice, bitsPerPixel);
+    job.dstPlan = cache.get(dst, dstLevel, dstSlice, bitsPerPixel);
+    job.srcImageData = GX2GetSurfaceLevelImageData(src, srcLevel);
+    job.dstImageData = GX2GetSurfaceLevelImageData(dst, dstLevel);
+
+    // Split the level on macro tile row boundaries (at most 4 micro tiles
+    // high), so that jobs do not write to the same cache lines
+    const u32 numTileRows = DivRoundUp(job.dstPlan->height, 8);
+    const size_t tileRowSize = std::max<size_t>((size_t)job.dstPlan->pitch * 8 * job.dstPlan->bytesPerElem, 1);
+
+    u32 tileRowsPerJob = numTileRows;
+    if (tileRowSize * numTileRows > GX2_COPY_SURFACE_MIN_JOB_SIZE)
+        tileRowsPerJob = RoundUp((u32)((GX2_COPY_SURFACE_MIN_JOB_SIZE + tileRowSize - 1) / tileRowSize), 4);
+
+    for (u32 tileRow = 0; tileRow < numTileRows; tileRow += tileRowsPerJob)
+    {
+        job.tileRowBegin = tileRow;
+        job.tileRowEnd = std::min(tileRow + tileRowsPerJob, numTileRows);
+        jobs->push_back(job);
+    }
+}
+
+static void GX2RunCopySurfaceJob(void* userData, u32 index)
+{
+    const GX2CopySurfaceJob& job = (*(const std::vector<GX2CopySurfaceJob>*)userData)[index];
+
+    const GX2TilingPlan* pSrc = job.srcPlan.get();
+    const GX2TilingPlan* pDst = job.dstPlan.get();
+
+    switch (pSrc->bytesPerElem)
+    {
+    case 16: GX2CopySurfaceLevel<16>(pSrc, job.srcImageData, pDst, job.dstImageData, job.tileRowBegin, job.tileRowEnd); break;
+    case 8:  GX2CopySurfaceLevel< 8>(pSrc, job.srcImageData, pDst, job.dstImageData, job.tileRowBegin, job.tileRowEnd); break;
+    case 4:  GX2CopySurfaceLevel< 4>(pSrc, job.srcImageData, pDst, job.dstImageData, job.tileRowBegin, job.tileRowEnd); break;
+    case 2:  GX2CopySurfaceLevel< 2>(pSrc, job.srcImageData, pDst, job.dstImageData, job.tileRowBegin, job.tileRowEnd); break;
+    case 1:  GX2CopySurfaceLevel< 1>(pSrc, job.srcImageData, pDst, job.dstImageData, job.tileRowBegin, job.tileRowEnd); break;
+    }
+}
+
+static void GX2RunCopySurfaceJobs(std::vector<GX2CopySurfaceJob>* jobs)
+{
+    TexThreadPool_ParallelFor((u32)jobs->size(), GX2RunCopySurfaceJob, jobs);
+}
+
+// Appends the byte ranges, relative to the image data of the level, of the
+// elements [x0, x1) x [y0, y1) of the level. Full micro tiles contribute
+// their runs, other elements one range each.
+static void GX2AddSurfaceRegionByteRanges(const GX2TilingPlan* plan, u32 x0, u32 y0, u32 x1, u32 y1,
+                                          std::vector< std::pair<u32, u32> >* ranges)
+{
+    const u32 bytesPerElem = plan->bytesPerElem;
+
+    if (!plan->hasMicroTileOffs)
+    {
+        for (u32 y = y0; y < y1; y++)
+            for (u32 x = x0; x < x1; x++)
+                ranges->emplace_back(GX2ComputeTilingPlanElemAddr(plan, x, y), bytesPerElem);
+
+        return;
+    }
+
+    for (u32 tileY = y0 & ~7u; tileY < y1; tileY += 8)
+    {
+        const u32 j0 = std::max(y0, tileY) - tileY;
+        const u32 j1 = std::min(y1, tileY + 8) - tileY;
+
+        for (u32 tileX = x0 & ~7u; tileX < x1; tileX += 8)
+        {
+            const u32 i0 = std::max(x0, tileX) - tileX;
+            const u32 i1 = std::min(x1, tileX + 8) - tileX;
+
+            const u32 tileAddr = GX2ComputeTilingPlanElemAddr(plan, tileX, tileY);
+
+            if (i0 == 0 && i1 == 8 && j0 == 0 && j1 == 8)
+            {
+                for (u32 k = 0; k < plan->numMicroTileRuns; k++)
+                    ranges->emplace_back(tileAddr + plan->microTileRunOffs[k], plan->microTileRunSizes[k]);
+
+                continue;
+            }
+
+            for (u32 j = j0; j < j1; j++)
+                for (u32 i = i0; i < i1; i++)
+                    ranges->emplace_back(tileAddr + plan->microTileOffs[j * 8 + i], bytesPerElem);
+        }
+    }
+}
+
+static BCnFormat GX2SurfaceFormatToBCnFormat(GX2SurfaceFormat format)
+{
+    switch (format)
+    {
+    case GX2_SURFACE_FORMAT_UNORM_BC1:
+    case GX2_SURFACE_FORMAT_SRGB_BC1:
+        return BCN_FORMAT_BC1;
+    case GX2_SURFACE_FORMAT_UNORM_BC2:
+    case GX2_SURFACE_FORMAT_SRGB_BC2:
+        return BCN_FORMAT_BC2;
+    case GX2_SURFACE_FORMAT_UNORM_BC3:
+    case GX2_SURFACE_FORMAT_SRGB_BC3:
+        return BCN_FORMAT_BC3;
+    case GX2_SURFACE_FORMAT_UNORM_BC4:
+        return BCN_FORMAT_BC4U;
+    case GX2_SURFACE_FORMAT_SNORM_BC4:
+        return BCN_FORMAT_BC4S;
+    case GX2_SURFACE_FORMAT_UNORM_BC5:
+        return BCN_FORMAT_BC5U;
+    case GX2_SURFACE_FORMAT_SNORM_BC5:
+        return BCN_FORMAT_BC5S;
+    default:
+        assert(false);
+        return BCN_FORMAT_BC1;
+    }
+}
+
+static inline bool GX2TilingPlanIsLinear(const GX2TilingPlan* plan)
+{
+    return plan->linearSpecial ||
+           plan->addrFromCoordIn.tileMode == ADDR_TM_LINEAR_GENERAL ||
+           plan->addrFromCoordIn.tileMode == ADDR_TM_LINEAR_ALIGNED;
+}
+
+// Reads elements [x0, x1) of rows of a level: in place from linear image
+// data, or gathered (in order) to a buffer from tiled image data.
+// Without micro tile addresses in the plan, the addresses of the micro
+// tiles of the current micro tile row are computed as needed.
+template <u32 bytesPerElem>
+class GX2SurfaceRowReader
+{
+public:
+    GX2SurfaceRowReader(const GX2TilingPlan* plan, uintptr_t pImageData, u32 x0, u32 x1)
+        : mPlan(plan)
+        , mImageData(pImageData)
+        , mX0(x0)
+        , mX1(x1)
+        , mIsLinear(GX2TilingPlanIsLinear(plan))
+        , mFirstTileX(x0 & ~7u)
+        , mMicroTileRow(~0u)
+    {
+        if (!mIsLinear)
+            mRow.resize((size_t)(x1 - x0) * bytesPerElem);
+    }
+
+    const u8* read(u32 y)
+    {
+        if (mIsLinear)
+            return (const u8*)(mImageData + GX2ComputeTilingPlanElemAddr(mPlan, mX0, y));
+
+        if (!mPlan->hasMicroTileOffs)
+        {
+            for (u32 x = mX0; x < mX1; x++)
+                std::memcpy(&mRow[(x - mX0) * bytesPerElem], (const void*)(mImageData + GX2ComputeTilingPlanElemAddr(mPlan, x, y)), bytesPerElem);
+
+            return mRow.data();
+        }
+
+        const u32* pMicroTileAddrs;
+        if (!mPlan->microTileAddrs.empty())
+        {
+            pMicroTileAddrs = mPlan->microTileAddrs.data() + (size_t)(y / 8) * mPlan->microTilesPerRow + mFirstTileX / 8;
+        }
+        else
+        {
+            if (mMicroTileRow != y / 8)
+            {
+                mMicroTileRow = y / 8;
+                mMicroTileAddrs.resize(DivRoundUp(mX1 - mFirstTileX, 8));
+                for (u32 k = 0; k < mMicroTileAddrs.size(); k++)
+                    mMicroTileAddrs[k] = GX2ComputeTilingPlanElemAddr(mPlan, mFirstTileX + k * 8, mMicroTileRow * 8);
+            }
+
+            pMicroTileAddrs = mMicroTileAddrs.data();
+        }
+
+        const u32* pMicroTileOffs = mPlan->microTileOffs + (y & 7) * 8;
+        u8* pRow = mRow.data();
+
+        for (u32 x = mX0; x < mX1; )
+        {
+            const uintptr_t pTile = mImageData + *pMicroTileAddrs++;
+            const u32 tileXEnd = std::min((x & ~7u) + 8, mX1);
+
+            for (; x < tileXEnd; x++)
+                std::memcpy(pRow + (x - mX0) * bytesPerElem, (const void*)(pTile + pMicroTileOffs[x & 7]), bytesPerElem);
+        }
+
+        return pRow;
+    }
+
+private:
+    const GX2TilingPlan* mPlan;
+    uintptr_t mImageData;
+    u32 mX0;
+    u32 mX1;
+    bool mIsLinear;
+    u32 mFirstTileX;
+    u32 mMicroTileRow;
+    std::vector<u32> mMicroTileAddrs;
+    std::vector<u8> mRow;
+};
+
+// A range of rows of elements of a region of a level to decode to RGBA8.
+// Rows of elements are decoded to disjoint rows of texels, so jobs can run
+// in any order.
+struct GX2DecodeSurfaceJob
+{
+    std::shared_ptr<const GX2TilingPlan> plan;
+    uintptr_t imageData;
+    bool compressed;
+    BCnFormat bcnFormat;                    // Compressed formats
+    TexFormatUtilsFormat format;            // Other formats
+    TexFormatUtilsComponent compSel[4];     // Other formats
+    u32 levelWidth;         // In texels
+    u32 levelHeight;        // In texels
+    u32 x;                  // Region, in texels
+    u32 y;
+    u32 width;
+    u32 height;
+    u8* outData;            // width * 4 bytes per row
+    u32 rowsPerJob;         // Multiple of 8, counted from the micro tile row of y
+};
+
+// Regions decoded to less than this many bytes are decoded by a single job
+static const size_t GX2_DECODE_SURFACE_MIN_JOB_SIZE = 0x40000;
+
+// Each row of blocks of the region is decoded straight to the output if it
+// is aligned on blocks, or through a 4-texel high strip otherwise.
+// Only the micro tiles and blocks overlapping the region are read.
+template <u32 bytesPerElem>
+static void GX2DecompressSurfaceRows(const GX2DecodeSurfaceJob& job, u32 blockRowBegin, u32 blockRowEnd)
+{
+    const u32 blockXBegin = job.x / 4;
+    const u32 blockXEnd = DivRoundUp(job.x + job.width, 4);
+    const u32 numBlocks = blockXEnd - blockXBegin;
+
+    const u32 outPitch = job.width * 4;
+    const u32 stripWidth = std::min(numBlocks * 4, job.levelWidth - blockXBegin * 4);
+    const u32 stripPitch = numBlocks * 4 * 4;
+
+    GX2SurfaceRowReader<bytesPerElem> reader(job.plan.get(), job.imageData, blockXBegin, blockXEnd);
+    std::vector<u8> strip;
+
+    for (u32 blockY = blockRowBegin; blockY < blockRowEnd; blockY++)
+    {
+        const u8* pRow = reader.read(blockY);
+
+        const u32 texelY = blockY * 4;
+        const u32 rowBegin = std::max(texelY, job.y);
+        const u32 rowEnd = std::min(texelY + 4, job.y + job.height);
+
+        if ((job.x & 3) == 0 && texelY >= job.y)
+        {
+            BCn_DecompressBlockRow(job.bcnFormat, job.width, rowEnd - texelY, pRow,
+                                   job.outData + (size_t)(texelY - job.y) * outPitch, outPitch);
+            continue;
+        }
+
+        strip.resize((size_t)stripPitch * 4);
+        BCn_DecompressBlockRow(job.bcnFormat, stripWidth, std::min(job.levelHeight - texelY, 4u), pRow,
+                               strip.data(), stripPitch);
+
+        for (u32 y = rowBegin; y < rowEnd; y++)
+            std::memcpy(job.outData + (size_t)(y - job.y) * outPitch,
+                        strip.data() + (y - texelY) * stripPitch + (job.x - blockXBegin * 4) * 4,
+                        outPitch);
+    }
+}
+
+// Each row of texels of the region is converted as soon as it is read
+template <u32 bytesPerElem>
+static void GX2ConvertSurfaceRows(const GX2DecodeSurfaceJob& job, u32 rowBegin, u32 rowEnd)
+{
+    const u32 outPitch = job.width * 4;
+
+    GX2SurfaceRowReader<bytesPerElem> reader(job.plan.get(), job.imageData, job.x, job.x + job.width);
+
+    for (u32 y = rowBegin; y < rowEnd; y++)
+        TexFormatUtils_ToRGBA8_CompSelArr(job.width, 1, reader.read(y),
+                                          job.outData + (size_t)(y - job.y) * outPitch,
+                                          job.format, job.compSel);
+}
+
+static void GX2RunDecodeSurfaceJob(void* userData, u32 index)
+{
+    const GX2DecodeSurfaceJob& job = *(const GX2DecodeSurfaceJob*)userData;
+
+    const u32 elemY = job.compressed ? job.y / 4 : job.y;
+    const u32 elemYEnd = job.compressed ? DivRoundUp(job.y + job.height, 4) : job.y + job.height;
+
+    const u32 rowBegin = std::max((elemY & ~7u) + index * job.rowsPerJob, elemY);
+    const u32 rowEnd = std::min((elemY & ~7u) + (index + 1) * job.rowsPerJob, elemYEnd);
+
+    switch (job.plan->bytesPerElem)
+    {
+    case 16: GX2DecompressSurfaceRows<16>(job, rowBegin, rowEnd); break;
+    case 8:  GX2DecompressSurfaceRows< 8>(job, rowBegin, rowEnd); break;
+    case 4:  GX2ConvertSurfaceRows< 4>(job, rowBegin, rowEnd); break;
+    case 2:  GX2ConvertSurfaceRows< 2>(job, rowBegin, rowEnd); break;
+    case 1:  GX2ConvertSurfaceRows< 1>(job, rowBegin, rowEnd); break;
+    }
+}
+
+static void GX2RunDecodeSurfaceJobs(GX2DecodeSurfaceJob* job)
+{
+    // Split the region on micro tile row boundaries, so that jobs read
+    // whole micro tiles
+    const u32 elemY = job->compressed ? job->y / 4 : job->y;
+    const u32 elemYEnd = job->compressed ? DivRoundUp(job->y + job->height, 4) : job->y + job->height;
+    const u32 numRows = elemYEnd - (elemY & ~7u);
+    const size_t rowSize = (size_t)job->width * 4 * (job->compressed ? 4 : 1);
+
+    job->rowsPerJob = RoundUp(numRows, 8);
+    if (rowSize * (elemYEnd - elemY) > GX2_DECODE_SURFACE_MIN_JOB_SIZE)
+        job->rowsPerJob = RoundUp((u32)((GX2_DECODE_SURFACE_MIN_JOB_SIZE + rowSize - 1) / rowSize), 8);
+
+    TexThreadPool_ParallelFor(DivRoundUp(numRows, job->rowsPerJob), GX2RunDecodeSurfaceJob, job);
+}
+
+static bool GX2SurfaceFormatToTexFormatUtilsFormat(GX2SurfaceFormat format, TexFormatUtilsFormat* pFormat)
+{
+    switch (format)
+    {
+    case GX2_SURFACE_FORMAT_UNORM_R8:      *pFormat = TEX_FORMAT_UTILS_FORMAT_L8;      return true;
+    case GX2_SURFACE_FORMAT_UNORM_RG4:     *pFormat = TEX_FORMAT_UTILS_FORMAT_LA4;     return true;
+    case GX2_SURFACE_FORMAT_UNORM_RG8:     *pFormat = TEX_FORMAT_UTILS_FORMAT_LA8;     return true;
+    case GX2_SURFACE_FORMAT_UNORM_RGB565:  *pFormat = TEX_FORMAT_UTILS_FORMAT_RGB565;  return true;
+    case GX2_SURFACE_FORMAT_UNORM_RGB5A1:  *pFormat = TEX_FORMAT_UTILS_FORMAT_RGB5A1;  return true;
+    case GX2_SURFACE_FORMAT_UNORM_RGBA4:   *pFormat = TEX_FORMAT_UTILS_FORMAT_RGBA4;   return true;
+    case GX2_SURFACE_FORMAT_UNORM_RGB10A2: *pFormat = TEX_FORMAT_UTILS_FORMAT_RGB10A2; return true;
+    case GX2_SURFACE_FORMAT_UNORM_RGBA8:
+    case GX2_SURFACE_FORMAT_SRGB_RGBA8:    *pFormat = TEX_FORMAT_UTILS_FORMAT_RGBA8;   return true;
+    default:
+        return false;
+    }
+}
+
+// Mip levels are filtered in bands of rows reading at least this many
+// bytes of f32 texels of the previous level, so that the previous level is
+// held as RGBA8 and only the rows of the current band as f32
+static const size_t GX2_GENERATE_MIPS_MIN_BAND_SIZE = 0x1000000;
+
+static inline bool GX2SurfaceFormatIsSRGB(GX2SurfaceFormat format)
+{
+    return format == GX2_SURFACE_FORMAT_SRGB_RGBA8 ||
+           format == GX2_SURFACE_FORMAT_SRGB_BC1 ||
+           format == GX2_SURFACE_FORMAT_SRGB_BC2 ||
+           format == GX2_SURFACE_FORMAT_SRGB_BC3;
+}
+
+static void GX2CompressBCn(BCnFormat format, u32 width, u32 height, const u8* inData, u8* outData)
+{
+    switch (format)
+    {
+    case BCN_FORMAT_BC1:  BCn_CompressBC1Parallel (width, height, inData, outData, BCN_QUALITY_NORMAL); break;
+    case BCN_FORMAT_BC2:  BCn_CompressBC2Parallel (width, height, inData, outData, BCN_QUALITY_NORMAL); break;
+    case BCN_FORMAT_BC3:  BCn_CompressBC3Parallel (width, height, inData, outData, BCN_QUALITY_NORMAL); break;
+    case BCN_FORMAT_BC4U: BCn_CompressBC4UParallel(width, height, inData, outData, BCN_QUALITY_NORMAL); break;
+    case BCN_FORMAT_BC4S: BCn_CompressBC4SParallel(width, height, inData, outData, BCN_QUALITY_NORMAL); break;
+    case BCN_FORMAT_BC5U: BCn_CompressBC5UParallel(width, height, inData, outData, BCN_QUALITY_NORMAL); break;
+    case BCN_FORMAT_BC5S: BCn_CompressBC5SParallel(width, height, inData, outData, BCN_QUALITY_NORMAL); break;
+    }
+}
+
+extern "C"
+{
+
+void GX2CopySurface(const GX2Surface* src, u32 srcLevel, u32 srcSlice,
+                          GX2Surface* dst, u32 dstLevel, u32 dstSlice)
+{
+    std::vector<GX2CopySurfaceJob> jobs;
+    GX2AddCopySurfaceJobs(&jobs, src, srcLevel, srcSlice, dst, dstLevel, dstSlice);
+    GX2RunCopySurfaceJobs(&jobs);
+}
+
+void GX2ResampleSurface(const GX2Surface* src, u32 srcLevel, u32 srcSlice,
+                              GX2Surface* dst, u32 dstLevel, u32 dstSlice)
+{
+    GX2CopySurface(src, srcLevel, srcSlice, dst, dstLevel, dstSlice);
+}
+
+void GX2CopySurfaceLevels(const GX2Surface* src, GX2Surface* dst, u32 numLevels)
+{
+    std::vector<GX2CopySurfaceJob> jobs;
+
+    for (u32 level = 0; level < numLevels; level++)
+    {
+        u32 numSlices = std::max(std::min(src->depth, dst->depth), 1u);
+        if (src->dim == GX2_SURFACE_DIM_3D)
+            numSlices = std::max(numSlices >> level, 1u);
+
+        for (u32 slice = 0; slice < numSlices; slice++)
+            GX2AddCopySurfaceJobs(&jobs, src, level, slice, dst, level, slice);
+    }
+
+    GX2RunCopySurfaceJobs(&jobs);
+}
+
+void GX2RetileSurface(const GX2Surface* src, GX2Surface* dst)
+{
+    assert(src->dim == dst->dim);
+    assert(src->width == dst->width && src->height == dst->height && src->depth == dst->depth);
+    assert(src->numMips == dst->numMips);
+    assert(src->format == dst->format);
+    assert(src->aa == dst->aa);
+
+    // Only the swizzle changes (if at all): move whole groups
+    if (src->tileMode == dst->tileMode && ((src->swizzle ^ dst->swizzle) & ~0xFF00u) == 0)
+    {
+        GX2RebaseSurfaceSwizzle(src, dst);
+        return;
+    }
+
+    GX2CopySurfaceLevels(src, dst, src->numMips);
+}
+
+void GX2RebaseSurfaceSwizzle(const GX2Surface* src, GX2Surface* dst)
+{
+    assert(src->dim == dst->dim);
+    assert(src->width == dst->width && src->height == dst->height && src->depth == dst->depth);
+    assert(src->numMips == dst->numMips);
+    assert(src->format == dst->format);
+    assert(src->aa == dst->aa);
+    assert(src->use == dst->use);
+    assert(src->tileMode == dst->tileMode);
+    assert(((src->swizzle ^ dst->swizzle) & ~0xFF00u) == 0);
+
+    for (u32 level = 0; level < src->numMips; level++)
+        GX2RebaseSurfaceLevelSwizzle(src, dst, level);
+}
+
+void GX2CopySurfaceSequentialRead(const GX2Surface* src, u32 srcLevel, u32 srcSlice,
+                                        GX2Surface* dst, u32 dstLevel, u32 dstSlice)
+{
+    u32 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(src->format);
+
+    GX2TilingPlanCache& cache = GX2GetTilingPlanCache();
+
+    std::shared_ptr<const GX2TilingPlan> srcPlan = cache.get(src, srcLevel, srcSlice, bitsPerPixel);
+    std::shared_ptr<const GX2TilingPlan> dstPlan = cache.get(dst, dstLevel, dstSlice, bitsPerPixel);
+    uintptr_t srcImageData = GX2GetSurfaceLevelImageData(src, srcLevel);
+    uintptr_t dstImageData = GX2GetSurfaceLevelImageData(dst, dstLevel);
+
+    switch (bitsPerPixel / 8)
+    {
+    case 16: GX2CopySurfaceLevelSequentialRead<16>(srcPlan.get(), srcImageData, dstPlan.get(), dstImageData); break;
+    case 8:  GX2CopySurfaceLevelSequentialRead< 8>(srcPlan.get(), srcImageData, dstPlan.get(), dstImageData); break;
+    case 4:  GX2CopySurfaceLevelSequentialRead< 4>(srcPlan.get(), srcImageData, dstPlan.get(), dstImageData); break;
+    case 2:  GX2CopySurfaceLevelSequentialRead< 2>(srcPlan.get(), srcImageData, dstPlan.get(), dstImageData); break;
+    case 1:  GX2CopySurfaceLevelSequentialRead< 1>(srcPlan.get(), srcImageData, dstPlan.get(), dstImageData); break;
+    }
+}
+
+void GX2DecompressSurface(const GX2Surface* surf, u32 level, u32 slice, u8* outData)
+{
+    assert(GX2SurfaceIsCompressed(surf->format));
+
+    u32 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(surf->format);
+
+    GX2DecodeSurfaceJob job;
+    job.plan = GX2GetTilingPlanCache().get(surf, level, slice, bitsPerPixel);
+    job.imageData = GX2GetSurfaceLevelImageData(surf, level);
+    job.compressed = true;
+    job.bcnFormat = GX2SurfaceFormatToBCnFormat(surf->format);
+    job.levelWidth = std::max(surf->width >> level, 1u);
+    job.levelHeight = std::max(surf->height >> level, 1u);
+    job.x = 0;
+    job.y = 0;
+    job.width = job.levelWidth;
+    job.height = job.levelHeight;
+    job.outData = outData;
+
+    GX2RunDecodeSurfaceJobs(&job);
+}
+
+void GX2DecompressSurfaceRegion(const GX2Surface* surf, u32 level, u32 slice,
+                                u32 x, u32 y, u32 width, u32 height, u8* outData)
+{
+    assert(GX2SurfaceIsCompressed(surf->format));
+
+    u32 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(surf->format);
+
+    GX2DecodeSurfaceJob job;
+    job.imageData = GX2GetSurfaceLevelImageData(surf, level);
+    job.compressed = true;
+    job.bcnFormat = GX2SurfaceFormatToBCnFormat(surf->format);
+    job.levelWidth = std::max(surf->width >> level, 1u);
+    job.levelHeight = std::max(surf->height >> level, 1u);
+    job.x = x;
+    job.y = y;
+    job.width = width;
+    job.height = height;
+    job.outData = outData;
+
+    assert(width <= job.levelWidth && x <= job.levelWidth - width);
+    assert(height <= job.levelHeight && y <= job.levelHeight - height);
+
+    if (width == 0 || height == 0)
+        return;
+
+    // Only the addresses of the micro tiles overlapping the region are
+    // computed, rather than those of the whole level
+    job.plan = GX2BuildTilingPlan(surf, level, slice, bitsPerPixel, false);
+
+    GX2RunDecodeSurfaceJobs(&job);
+}
+
+bool GX2ConvertSurfaceToRGBA8(const GX2Surface* surf, u32 level, u32 slice, u32 compSel, u8* outData)
+{
+    GX2DecodeSurfaceJob job;
+    if (!GX2SurfaceFormatToTexFormatUtilsFormat(surf->format, &job.format))
+        return false;
+
+    u32 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(surf->format);
+
+    job.plan = GX2GetTilingPlanCache().get(surf, level, slice, bitsPerPixel);
+    job.imageData = GX2GetSurfaceLevelImageData(surf, level);
+    job.compressed = false;
+    job.compSel[0] = (TexFormatUtilsComponent)(compSel >> 24 & 0xFF);
+    job.compSel[1] = (TexFormatUtilsComponent)(compSel >> 16 & 0xFF);
+    job.compSel[2] = (TexFormatUtilsComponent)(compSel >>  8 & 0xFF);
+    job.compSel[3] = (TexFormatUtilsComponent)(compSel       & 0xFF);
+    job.levelWidth = std::max(surf->width >> level, 1u);
+    job.levelHeight = std::max(surf->height >> level, 1u);
+    job.x = 0;
+    job.y = 0;
+    job.width = job.levelWidth;
+    job.height = job.levelHeight;
+    job.outData = outData;
+
+    GX2RunDecodeSurfaceJobs(&job);
+    return true;
+}
+
+bool GX2GenerateSurfaceMips(GX2Surface* surf, TexMipUtilsFilter filter)
+{
+    if (!GX2SurfaceFormatCanGenerateMips(surf->format) || surf->dim == GX2_SURFACE_DIM_3D)
+        return false;
+
+    const bool compressed = GX2SurfaceIsCompressed(surf->format);
+
+    TexFormatUtilsFormat format = TEX_FORMAT_UTILS_FORMAT_RGBA8;
+    if (!compressed)
+        GX2SurfaceFormatToTexFormatUtilsFormat(surf->format, &format);
+
+    assert(surf->aa == GX2_AA_MODE_1X);
+
+    const bool srgb = GX2SurfaceFormatIsSRGB(surf->format);
+    const BCnFormat bcnFormat = compressed ? GX2SurfaceFormatToBCnFormat(surf->format) : BCN_FORMAT_BC1;
+    const u32 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(surf->format);
+
+    const u32 width = std::max(surf->width, 1u);
+    const u32 height = std::max(surf->height, 1u);
+    const u32 numSlices = std::max(surf->depth, 1u);
+
+    // Rows of level 0 are decoded from the surface as the bands need them
+    GX2DecodeSurfaceJob decodeJob;
+    decodeJob.imageData = GX2GetSurfaceLevelImageData(surf, 0);
+    decodeJob.compressed = compressed;
+    decodeJob.bcnFormat = bcnFormat;
+    decodeJob.format = format;
+    decodeJob.compSel[0] = TEX_FORMAT_UTILS_COMPONENT_R;
+    decodeJob.compSel[1] = TEX_FORMAT_UTILS_COMPONENT_G;
+    decodeJob.compSel[2] = TEX_FORMAT_UTILS_COMPONENT_B;
+    decodeJob.compSel[3] = TEX_FORMAT_UTILS_COMPONENT_A;
+    decodeJob.levelWidth = width;
+    decodeJob.levelHeight = height;
+    decodeJob.x = 0;
+    decodeJob.width = width;
+
+    // Each level is encoded to the image data of a linear surface of the
+    // dimensions of the level, then copied to the level of surf
+    GX2Surface linearSurface;
+    std::memset(&linearSurface, 0, sizeof(GX2Surface));
+    linearSurface.dim = GX2_SURFACE_DIM_2D;
+    linearSurface.depth = 1;
+    linearSurface.numMips = 1;
+    linearSurface.format = surf->format;
+    linearSurface.aa = GX2_AA_MODE_1X;
+    linearSurface.use = GX2_SURFACE_USE_TEXTURE;
+    linearSurface.tileMode = GX2_TILE_MODE_LINEAR_SPECIAL;
+
+    std::vector<u8> prevRGBA;       // RGBA8 texels of the previous level (from level 1 on)
+    std::vector<u8> levelRGBA;      // RGBA8 texels of the current level
+    std::vector<u8> levelData;      // Current level, in the format of the surface
+    std::vector<u8> decodedRows;    // Rows of level 0
+    std::vector<f32> window;        // Rows of the previous level read by the current band
+    std::vector<f32> bandData;      // Rows of the current level filtered by the current band
+
+    for (u32 slice = 0; slice < numSlices; slice++)
+    {
+        decodeJob.plan = GX2GetTilingPlanCache().get(surf, 0, slice, bitsPerPixel);
+
+        u32 prevWidth = width;
+        u32 prevHeight = height;
+
+        for (u32 mipLevel = 1; mipLevel < surf->numMips; mipLevel++)
+        {
+            const u32 levelWidth = std::max(width >> mipLevel, 1u);
+            const u32 levelHeight = std::max(height >> mipLevel, 1u);
+
+            levelRGBA.resize((size_t)levelWidth * levelHeight * 4);
+
+            const size_t srcRowSize = (size_t)prevWidth * 4;
+            const u32 srcRowsPerBand = (u32)std::max<size_t>(GX2_GENERATE_MIPS_MIN_BAND_SIZE / (srcRowSize * sizeof(f32)), 1);
+            const u32 rowsPerBand = std::max((u32)((u64)srcRowsPerBand * levelHeight / prevHeight), 1u);
+
+            // The window holds the rows [windowBegin, windowEnd) of the
+            // previous level as f32
+            u32 windowBegin = 0;
+            u32 windowEnd = 0;
+
+            for (u32 y = 0; y < levelHeight; y += rowsPerBand)
+            {
+                const u32 numRows = std::min(rowsPerBand, levelHeight - y);
+
+                u32 rowBegin, rowEnd;
+                TexMipUtils_GetDownsampleSourceRows(prevHeight, levelHeight, y, numRows, filter, &rowBegin, &rowEnd);
+
+                // Keep the rows shared with the previous band
+                if (rowBegin < windowEnd)
+                    std::memmove(window.data(), window.data() + (rowBegin - windowBegin) * srcRowSize,
+                                 (windowEnd - rowBegin) * srcRowSize * sizeof(f32));
+                else
+                    windowEnd = rowBegin;
+
+                windowBegin = rowBegin;
+                window.resize((rowEnd - rowBegin) * srcRowSize);
+
+                if (windowEnd < rowEnd)
+                {
+                    const u32 numNewRows = rowEnd - windowEnd;
+                    const u8* newRows = prevRGBA.data() + windowEnd * srcRowSize;
+
+                    if (mipLevel == 1)
+                    {
+                        decodedRows.resize(numNewRows * srcRowSize);
+                        decodeJob.y = windowEnd;
+                        decodeJob.height = numNewRows;
+                        decodeJob.outData = decodedRows.data();
+                        GX2RunDecodeSurfaceJobs(&decodeJob);
+                        newRows = decodedRows.data();
+                    }
+
+                    TexMipUtils_RGBA8ToFloat(prevWidth * numNewRows, newRows,
+                                             window.data() + (windowEnd - windowBegin) * srcRowSize, srgb);
+                    windowEnd = rowEnd;
+                }
+
+                bandData.resize((size_t)levelWidth * numRows * 4);
+                TexMipUtils_DownsampleRows(prevWidth, prevHeight, windowBegin, window.data(),
+                                           levelWidth, levelHeight, y, numRows, bandData.data(), filter);
+                TexMipUtils_FloatToRGBA8(levelWidth * numRows, bandData.data(),
+                                         levelRGBA.data() + (size_t)y * levelWidth * 4, srgb);
+            }
+
+            linearSurface.width = levelWidth;
+            linearSurface.height = levelHeight;
+            GX2CalcSurfaceSizeAndAlignment(&linearSurface);
+
+            levelData.resize(linearSurface.imageSize);
+            linearSurface.imagePtr = levelData.data();
+
+            if (compressed)
+                GX2CompressBCn(bcnFormat, levelWidth, levelHeight, levelRGBA.data(), levelData.data());
+            else
+                TexFormatUtils_FromRGBA8(levelWidth, levelHeight, levelRGBA.data(), levelData.data(), format, false);
+
+            GX2CopySurface(&linearSurface, 0, 0, surf, mipLevel, slice);
+
+            prevRGBA.swap(levelRGBA);
+            prevWidth = levelWidth;
+            prevHeight = levelHeight;
+        }
+    }
+
+    return true;
+}
+
+bool GX2SurfaceFormatCanGenerateMips(GX2SurfaceFormat format)
+{
+    TexFormatUtilsFormat texFormat;
+    return GX2SurfaceIsCompressed(format) || GX2SurfaceFormatToTexFormatUtilsFormat(format, &texFormat);
+}
+
+u32 GX2GetSurfaceRegionByteRanges(const GX2Surface* surf, u32 level, u32 slice,
+                                   u32 x, u32 y, u32 width, u32 height,
+                                   GX2SurfaceByteRange* ranges, u32 maxRanges)
+{
+    assert(surf->aa == GX2_AA_MODE_1X);
+
+    const u32 levelWidth = std::max(surf->width >> level, 1u);
+    const u32 levelHeight = std::max(surf->height >> level, 1u);
+
+    assert(width <= levelWidth && x <= levelWidth - width);
+    assert(height <= levelHeight && y <= levelHeight - height);
+
+    if (width == 0 || height == 0)
+        return 0;
+
+    u32 x0 = x, x1 = x + width;
+    u32 y0 = y, y1 = y + height;
+
+    if (GX2SurfaceIsCompressed(surf->format))
+    {
+        x0 /= 4; x1 = DivRoundUp(x1, 4);
+        y0 /= 4; y1 = DivRoundUp(y1, 4);
+    }
+
+    u32 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(surf->format);
+    std::shared_ptr<const GX2TilingPlan> plan = GX2BuildTilingPlan(surf, level, slice, bitsPerPixel, false);
+
+    std::vector< std::pair<u32, u32> > elemRanges;
+    GX2AddSurfaceRegionByteRanges(plan.get(), x0, y0, x1, y1, &elemRanges);
+    std::sort(elemRanges.begin(), elemRanges.end());
+
+    // Levels after the first two are stored at mipOffset[level - 1] of mipPtr
+    const u32 levelOffset = level >= 2 ? surf->mipOffset[level - 1] : 0;
+
+    u32 numRanges = 0;
+    u32 rangeBegin = 0;
+    u32 rangeEnd = 0;
+
+    for (size_t k = 0; k <= elemRanges.size(); k++)
+    {
+        if (k < elemRanges.size() && numRanges != 0 && elemRanges[k].first <= rangeEnd)
+        {
+            rangeEnd = std::max(rangeEnd, elemRanges[k].first + elemRanges[k].second);
+            continue;
+        }
+
+        if (numRanges != 0 && numRanges <= maxRanges)
+        {
+            ranges[numRanges - 1].offset = levelOffset + rangeBegin;
+            ranges[numRanges - 1].size = rangeEnd - rangeBegin;
+        }
+
+        if (k < elemRanges.size())
+        {
+            rangeBegin = elemRanges[k].first;
+            rangeEnd = rangeBegin + elemRanges[k].second;
+            numRanges++;
+        }
+    }
+
+    return numRanges;
+}
+
+void GX2SetTilingPlanCacheSize(size_t maxSize)
+{
+    GX2GetTilingPlanCache().setMaxSize(maxSize);
+}
+
+void GX2PrebuildTilingPlan(const GX2Surface* surf, u32 level, u32 slice, bool pin)
+{
+    GX2GetTilingPlanCache().get(surf, level, slice, GX2GetSurfaceFormatBitsPerPixel(surf->format), pin);
+}
+
+void GX2ClearTilingPlanCache(bool unpin)
+{
+    GX2GetTilingPlanCache().clear(unpin);
+}
+
 #if INTPTR_MAX == INT64_MAX
     #define PTR_BSWAP(x) ((void*)__builtin_bswap64((uintptr_t)(x)))
 #else // assuming 32 bit
@@ -268,39 +268,10 @@ void GX2TexturePrintInfo(const GX2Texture* tex)
     std::cout << "  Alpha Channel   = " << comp_sel_str[compSel >>  0 & 0xFF] << std::endl;
 }
 
-void GX2TextureFromLinear2D(GX2Texture* texture, u32 width, u32 height, u32 numMips, GX2SurfaceFormat format, u32 compSel, const u8* imagePtr, size_t imageSize, GX2TileMode tileMode, u32 swizzle, const u8* mipPtr, size_t mipSize, bool gfd_v7)
+// Sets up texture for a 2D texture of the given layout, with its image
+// (and mip) data allocated
+static void GX2InitTexture2D(GX2Texture* texture, u32 width, u32 height, u32 numMips, GX2SurfaceFormat format, u32 compSel, GX2TileMode tileMode, u32 swizzle, bool gfd_v7)
 {
-    // Create a new GX2Surface to store the untiled texture
-    GX2Surface linear_surface;
-    linear_surface.dim = GX2_SURFACE_DIM_2D;
-    linear_surface.width = width;
-    linear_surface.height = height;
-    linear_surface.depth = 1;
-    linear_surface.numMips = numMips;
-    linear_surface.format = format;
-    linear_surface.aa = GX2_AA_MODE_1X;
-    linear_surface.use = GX2_SURFACE_USE_TEXTURE;
-    linear_surface.tileMode = GX2_TILE_MODE_LINEAR_SPECIAL;
-    linear_surface.swizzle = 0;
-
-    GX2CalcSurfaceSizeAndAlignment(&linear_surface);
-
-    // Validate and set the image data
-    assert(imageSize >= linear_surface.imageSize);
-    linear_surface.imagePtr = const_cast<u8*>(imagePtr);
-
-    // Validate and set the mip data
-    if (numMips > 1)
-    {
-        assert(mipSize >= linear_surface.mipSize);
-        linear_surface.mipPtr = const_cast<u8*>(mipPtr);
-    }
-    else
-    {
-        linear_surface.mipPtr = nullptr;
-    }
-
-    // Set up GX2Texture for the tiled texture
     std::memset(texture, 0, sizeof(GX2Texture));
     texture->surface.dim = GX2_SURFACE_DIM_2D;
     texture->surface.width = width;
@@ -328,11 +299,74 @@ void GX2TextureFromLinear2D(GX2Texture* texture, u32 width, u32 height, u32 numM
         texture->surface.mipPtr = (u8*)std::malloc(texture->surface.mipSize);
     else
         texture->surface.mipPtr = nullptr;
+}
+
+// Describes linear image (and mip) data of the given layout as a surface
+static void GX2InitLinearSurface2D(GX2Surface* linear_surface, u32 width, u32 height, u32 numMips, GX2SurfaceFormat format, const u8* imagePtr, size_t imageSize, const u8* mipPtr, size_t mipSize)
+{
+    linear_surface->dim = GX2_SURFACE_DIM_2D;
+    linear_surface->width = width;
+    linear_surface->height = height;
+    linear_surface->depth = 1;
+    linear_surface->numMips = numMips;
+    linear_surface->format = format;
+    linear_surface->aa = GX2_AA_MODE_1X;
+    linear_surface->use = GX2_SURFACE_USE_TEXTURE;
+    linear_surface->tileMode = GX2_TILE_MODE_LINEAR_SPECIAL;
+    linear_surface->swizzle = 0;
+
+    GX2CalcSurfaceSizeAndAlignment(linear_surface);
+
+    // Validate and set the image data
+    assert(imageSize >= linear_surface->imageSize);
+    linear_surface->imagePtr = const_cast<u8*>(imagePtr);
+
+    // Validate and set the mip data
+    if (numMips > 1)
+    {
+        assert(mipSize >= linear_surface->mipSize);
+        linear_surface->mipPtr = const_cast<u8*>(mipPtr);
+    }
+    else
+    {
+        linear_surface->mipPtr = nullptr;
+    }
+}
+
+void GX2TextureFromLinear2D(GX2Texture* texture, u32 width, u32 height, u32 numMips, GX2SurfaceFormat format, u32 compSel, const u8* imagePtr, size_t imageSize, GX2TileMode tileMode, u32 swizzle, const u8* mipPtr, size_t mipSize, bool gfd_v7)
+{
+    // Create a new GX2Surface to store the untiled texture
+    GX2Surface linear_surface;
+    GX2InitLinearSurface2D(&linear_surface, width, height, numMips, format, imagePtr, imageSize, mipPtr, mipSize);
+
+    // Set up GX2Texture for the tiled texture
+    GX2InitTexture2D(texture, width, height, numMips, format, compSel, tileMode, swizzle, gfd_v7);
 
     // Tile our texture
+    GX2CopySurfaceLevels(&linear_surface, &texture->surface, numMips);
+}
+
+bool GX2TextureFromLinear2DGenerateMips(GX2Texture* texture, u32 width, u32 height, u32 numMips, GX2SurfaceFormat format, u32 compSel, const u8* imagePtr, size_t imageSize, TexMipUtilsFilter filter, GX2TileMode tileMode, u32 swizzle, bool gfd_v7)
+{
+    if (!GX2SurfaceFormatCanGenerateMips(format))
+    {
+        std::memset(texture, 0, sizeof(GX2Texture));
+        return false;
+    }
+
+    // Only level 0 is supplied
+    GX2Surface linear_surface;
+    GX2InitLinearSurface2D(&linear_surface, width, height, 1, format, imagePtr, imageSize, nullptr, 0);
+
+    GX2InitTexture2D(texture, width, height, numMips, format, compSel, tileMode, swizzle, gfd_v7);
+
+    // Tile level 0, then generate the other levels from it
     GX2CopySurface(&linear_surface, 0, 0, &texture->surface, 0, 0);
-    for (u32 i = 1; i < numMips; i++)
-        GX2CopySurface(&linear_surface, i, 0, &texture->surface, i, 0);
+
+    // Cannot fail: the format was checked above and the texture is 2D
+    GX2GenerateSurfaceMips(&texture->surface, filter);
+
+    return true;
 }
 
 static const std::unordered_map<std::string, const u32> fourCCs_import {
@@ -715,9 +749,7 @@ u8* GX2TextureToDDS(const GX2Texture* texture, size_t* fileSize, bool printInfo)
         linear_surface.mipPtr = nullptr;
 
     // Untile our texture
-    GX2CopySurface(&texture->surface, 0, 0, &linear_surface, 0, 0);
-    for (u32 i = 1; i < numMips; i++)
-        GX2CopySurface(&texture->surface, i, 0, &linear_surface, i, 0);
+    GX2CopySurfaceLevels(&texture->surface, &linear_surface, numMips);
 
     // Bits-per-pixel and bytes-per-pixel
     const u8 bitsPerPixel = GX2GetSurfaceFormatBitsPerPixel(format);
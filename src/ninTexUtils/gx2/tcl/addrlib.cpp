@@ -1,5 +1,10 @@
+#include <ninTexUtils/cpu_features.h>
 #include <ninTexUtils/gx2/tcl/addrlib.h>
 
+#if defined(CPU_FEATURES_ARCH_X86)
+#include <immintrin.h>
+#endif
+
 #ifdef __GNUC__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wswitch"
@@ -588,6 +593,14 @@ ADDR_E_RETURNCODE AddrLib::ComputeSurfaceAddrFromCoord(
     return returnCode;
 }
 
+ADDR_E_RETURNCODE AddrLib::ComputeSurfaceCoordFromAddr(
+    const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+    ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+)
+{
+    return R600AddrLib::HwlComputeSurfaceCoordFromAddr(pIn, pOut);
+}
+
 u32 AddrLib::ComputeSurfaceThickness(AddrTileMode tileMode)
 {
     switch(tileMode)
@@ -685,6 +698,32 @@ u64 AddrLib::ComputeSurfaceAddrFromCoordLinear(
     return addr;
 }
 
+void AddrLib::ComputeSurfaceCoordFromAddrLinear(
+    u64 addr,
+    u32 bitPosition,
+    u32 bpp,
+    u32 pitch,
+    u32 height,
+    u32 numSlices,
+    u32* pX,
+    u32* pY,
+    u32* pSlice,
+    u32* pSample
+)
+{
+    const u64 sliceSize = (u64)pitch * height;
+
+    u64 pixOffset = (addr * 8 + bitPosition) / bpp;
+    u64 sliceIndex = pixOffset / sliceSize;
+
+    pixOffset %= sliceSize;
+
+    *pX = (u32)(pixOffset % pitch);
+    *pY = (u32)(pixOffset / pitch);
+    *pSlice = (u32)(sliceIndex % numSlices);
+    *pSample = (u32)(sliceIndex / numSlices);
+}
+
 u32 AddrLib::ComputePixelIndexWithinMicroTile(
     u32 x,
     u32 y,
@@ -806,6 +845,88 @@ u32 AddrLib::ComputePixelIndexWithinMicroTile(
     return pixelNumber;
 }
 
+// Inverse of ComputePixelIndexWithinMicroTile
+void AddrLib::ComputePixelCoordFromOffset(
+    u32 offset,
+    u32 bpp,
+    AddrTileMode tileMode,
+    AddrTileType microTileType,
+    u32* pX,
+    u32* pY,
+    u32* pSlice
+)
+{
+    u32 x = 0;
+    u32 y = 0;
+    u32 z = 0;
+
+    u32 pixelBit0 = (offset >> 0) & 1;
+    u32 pixelBit1 = (offset >> 1) & 1;
+    u32 pixelBit2 = (offset >> 2) & 1;
+    u32 pixelBit3 = (offset >> 3) & 1;
+    u32 pixelBit4 = (offset >> 4) & 1;
+    u32 pixelBit5 = (offset >> 5) & 1;
+    u32 pixelBit6 = (offset >> 6) & 1;
+    u32 pixelBit7 = (offset >> 7) & 1;
+    u32 pixelBit8 = (offset >> 8) & 1;
+
+    u32 thickness = ComputeSurfaceThickness(tileMode);
+
+    if (microTileType != ADDR_THICK)
+    {
+        if (microTileType == ADDR_DISPLAYABLE)
+        {
+            switch (bpp)
+            {
+            case 8:
+                x = pixelBit0 | pixelBit1 << 1 | pixelBit2 << 2;
+                y = pixelBit4 | pixelBit3 << 1;
+                break;
+            case 16:
+                x = pixelBit0 | pixelBit1 << 1 | pixelBit2 << 2;
+                y = pixelBit3 | pixelBit4 << 1;
+                break;
+            //case 32:
+            default:
+                x = pixelBit0 | pixelBit1 << 1 | pixelBit3 << 2;
+                y = pixelBit2 | pixelBit4 << 1;
+                break;
+            case 64:
+                x = pixelBit0 | pixelBit2 << 1 | pixelBit3 << 2;
+                y = pixelBit1 | pixelBit4 << 1;
+                break;
+            case 128:
+                x = pixelBit1 | pixelBit2 << 1 | pixelBit3 << 2;
+                y = pixelBit0 | pixelBit4 << 1;
+                break;
+            }
+        }
+        else
+        {
+            x = pixelBit0 | pixelBit2 << 1 | pixelBit4 << 2;
+            y = pixelBit1 | pixelBit3 << 1;
+        }
+
+        y |= pixelBit5 << 2;
+
+        if (thickness > 1)
+            z = pixelBit6 | pixelBit7 << 1;
+    }
+    else
+    {
+        x = pixelBit0 | pixelBit3 << 1 | pixelBit6 << 2;
+        y = pixelBit1 | pixelBit4 << 1 | pixelBit7 << 2;
+        z = pixelBit2 | pixelBit5 << 1;
+    }
+
+    if (thickness == 8)
+        z |= pixelBit8 << 2;
+
+    *pX = x;
+    *pY = y;
+    *pSlice = z;
+}
+
 u32 R600AddrLib::ComputeSurfaceTileSlices(
     AddrTileMode tileMode,
     u32 bpp,
@@ -2025,9 +2146,9 @@ u64 R600AddrLib::ComputeSurfaceAddrFromCoordMacroTiled(
     return addr;
 }
 
-u64 R600AddrLib::ComputeSurfaceAddrFromCoord(
+u64 R600AddrLib::ComputeSurfaceAddrFromCoordGeneric(
     const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
-    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT* pOut
+    u32* pBitPosition
 )
 {
     u32 x = pIn->x;
@@ -2046,7 +2167,6 @@ u64 R600AddrLib::ComputeSurfaceAddrFromCoord(
     u32 pipeSwizzle = pIn->pipeSwizzle;
     u32 bankSwizzle = pIn->bankSwizzle;
 
-    u32* pBitPosition = &pOut->bitPosition;
     u64 addr;
 
     switch (tileMode)
@@ -2112,6 +2232,443 @@ u64 R600AddrLib::ComputeSurfaceAddrFromCoord(
     return addr;
 }
 
+// Same as ComputeSurfaceAddrFromCoordGeneric, with the tile mode, bpp and
+// depth sample order known at compile time (so that everything derived
+// from them, down to the pixel index bits, is folded by the compiler)
+template <AddrTileMode tileMode, u32 bpp, bool isDepthSampleOrder>
+u64 R600AddrLib::ComputeSurfaceAddrFromCoordSpecialized(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    u32* pBitPosition
+)
+{
+    if (tileMode == ADDR_TM_1D_TILED_THIN1 ||
+        tileMode == ADDR_TM_1D_TILED_THICK)
+    {
+        return ComputeSurfaceAddrFromCoordMicroTiled(pIn->x,
+                                                     pIn->y,
+                                                     pIn->slice,
+                                                     bpp,
+                                                     pIn->pitch,
+                                                     pIn->height,
+                                                     tileMode,
+                                                     isDepthSampleOrder,
+                                                     pIn->tileBase,
+                                                     pIn->compBits,
+                                                     pBitPosition);
+    }
+    else
+    {
+        return ComputeSurfaceAddrFromCoordMacroTiled(pIn->x,
+                                                     pIn->y,
+                                                     pIn->slice,
+                                                     pIn->sample,
+                                                     bpp,
+                                                     pIn->pitch,
+                                                     pIn->height,
+                                                     (pIn->numSamples == 0) ? 1 : pIn->numSamples,
+                                                     tileMode,
+                                                     isDepthSampleOrder,
+                                                     pIn->tileBase,
+                                                     pIn->compBits,
+                                                     pIn->pipeSwizzle,
+                                                     pIn->bankSwizzle,
+                                                     pBitPosition);
+    }
+}
+
+template <AddrTileMode tileMode>
+ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC R600AddrLib::GetSurfaceAddrFromCoordFunc(
+    u32 bpp,
+    bool isDepthSampleOrder
+)
+{
+    switch (bpp)
+    {
+    case 8:
+        return isDepthSampleOrder ? ComputeSurfaceAddrFromCoordSpecialized<tileMode,   8, true>
+                                  : ComputeSurfaceAddrFromCoordSpecialized<tileMode,   8, false>;
+    case 16:
+        return isDepthSampleOrder ? ComputeSurfaceAddrFromCoordSpecialized<tileMode,  16, true>
+                                  : ComputeSurfaceAddrFromCoordSpecialized<tileMode,  16, false>;
+    case 32:
+        return isDepthSampleOrder ? ComputeSurfaceAddrFromCoordSpecialized<tileMode,  32, true>
+                                  : ComputeSurfaceAddrFromCoordSpecialized<tileMode,  32, false>;
+    case 64:
+        return isDepthSampleOrder ? ComputeSurfaceAddrFromCoordSpecialized<tileMode,  64, true>
+                                  : ComputeSurfaceAddrFromCoordSpecialized<tileMode,  64, false>;
+    case 128:
+        return isDepthSampleOrder ? ComputeSurfaceAddrFromCoordSpecialized<tileMode, 128, true>
+                                  : ComputeSurfaceAddrFromCoordSpecialized<tileMode, 128, false>;
+    default:
+        return ComputeSurfaceAddrFromCoordGeneric;
+    }
+}
+
+ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC R600AddrLib::GetSurfaceAddrFromCoordFunc(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn
+)
+{
+    u32 bpp = pIn->bpp;
+    bool isDepthSampleOrder = pIn->isDepth;
+
+    switch (pIn->tileMode)
+    {
+    case ADDR_TM_1D_TILED_THIN1: return GetSurfaceAddrFromCoordFunc<ADDR_TM_1D_TILED_THIN1>(bpp, isDepthSampleOrder);
+    case ADDR_TM_1D_TILED_THICK: return GetSurfaceAddrFromCoordFunc<ADDR_TM_1D_TILED_THICK>(bpp, isDepthSampleOrder);
+    case ADDR_TM_2D_TILED_THIN1: return GetSurfaceAddrFromCoordFunc<ADDR_TM_2D_TILED_THIN1>(bpp, isDepthSampleOrder);
+    case ADDR_TM_2D_TILED_THIN2: return GetSurfaceAddrFromCoordFunc<ADDR_TM_2D_TILED_THIN2>(bpp, isDepthSampleOrder);
+    case ADDR_TM_2D_TILED_THIN4: return GetSurfaceAddrFromCoordFunc<ADDR_TM_2D_TILED_THIN4>(bpp, isDepthSampleOrder);
+    case ADDR_TM_2D_TILED_THICK: return GetSurfaceAddrFromCoordFunc<ADDR_TM_2D_TILED_THICK>(bpp, isDepthSampleOrder);
+    case ADDR_TM_2B_TILED_THIN1: return GetSurfaceAddrFromCoordFunc<ADDR_TM_2B_TILED_THIN1>(bpp, isDepthSampleOrder);
+    case ADDR_TM_2B_TILED_THIN2: return GetSurfaceAddrFromCoordFunc<ADDR_TM_2B_TILED_THIN2>(bpp, isDepthSampleOrder);
+    case ADDR_TM_2B_TILED_THIN4: return GetSurfaceAddrFromCoordFunc<ADDR_TM_2B_TILED_THIN4>(bpp, isDepthSampleOrder);
+    case ADDR_TM_2B_TILED_THICK: return GetSurfaceAddrFromCoordFunc<ADDR_TM_2B_TILED_THICK>(bpp, isDepthSampleOrder);
+    case ADDR_TM_3D_TILED_THIN1: return GetSurfaceAddrFromCoordFunc<ADDR_TM_3D_TILED_THIN1>(bpp, isDepthSampleOrder);
+    case ADDR_TM_3D_TILED_THICK: return GetSurfaceAddrFromCoordFunc<ADDR_TM_3D_TILED_THICK>(bpp, isDepthSampleOrder);
+    case ADDR_TM_3B_TILED_THIN1: return GetSurfaceAddrFromCoordFunc<ADDR_TM_3B_TILED_THIN1>(bpp, isDepthSampleOrder);
+    case ADDR_TM_3B_TILED_THICK: return GetSurfaceAddrFromCoordFunc<ADDR_TM_3B_TILED_THICK>(bpp, isDepthSampleOrder);
+    default:
+        // Linear modes have nothing worth specializing
+        return ComputeSurfaceAddrFromCoordGeneric;
+    }
+}
+
+u64 R600AddrLib::ComputeSurfaceAddrFromCoord(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT* pOut
+)
+{
+    return GetSurfaceAddrFromCoordFunc(pIn)(pIn, &pOut->bitPosition);
+}
+
+void R600AddrLib::ComputeSurfaceCoordFromAddrMicroTiled(
+    u64 addr,
+    u32 bitPosition,
+    u32 bpp,
+    u32 pitch,
+    u32 height,
+    AddrTileMode tileMode,
+    bool isDepthSampleOrder,
+    u32 tileBase,
+    u32 compBits,
+    u32* pX,
+    u32* pY,
+    u32* pSlice
+)
+{
+    u32 microTileThickness = (tileMode == ADDR_TM_1D_TILED_THICK) ? 4 : 1;
+
+    u32 microTileBytes = (bpp * 64 + 7) / 8 * microTileThickness;
+
+    u64 sliceBytes = ((u64)pitch * height * microTileThickness * bpp + 7) / 8;
+
+    u32 microTilesPerRow = pitch / 8;
+
+    u32 microTileIndexZ = (u32)(addr / sliceBytes);
+    u64 sliceOffset = addr % sliceBytes;
+
+    u64 microTileIndex = sliceOffset / microTileBytes;
+    u32 microTileIndexX = (u32)(microTileIndex % microTilesPerRow);
+    u32 microTileIndexY = (u32)(microTileIndex / microTilesPerRow);
+
+    u32 elemOffset = (u32)(sliceOffset % microTileBytes) * 8 + bitPosition;
+
+    u32 pixelIndex;
+
+    if (compBits != 0 && compBits != bpp && isDepthSampleOrder)
+        pixelIndex = (elemOffset - tileBase) / compBits;
+
+    else
+        pixelIndex = elemOffset / bpp;
+
+    u32 pixelX, pixelY, pixelZ;
+    ComputePixelCoordFromOffset(pixelIndex,
+                                bpp,
+                                tileMode,
+                                (AddrTileType)isDepthSampleOrder,
+                                &pixelX,
+                                &pixelY,
+                                &pixelZ);
+
+    *pX = microTileIndexX * 8 + pixelX;
+    *pY = microTileIndexY * 8 + pixelY;
+    *pSlice = microTileIndexZ * microTileThickness + pixelZ;
+}
+
+// Inverse of ComputeSurfaceAddrFromCoordMacroTiled.
+// The macro tile, the element within the micro tile and the slice follow
+// from the address with the pipe and bank bits removed. The pipe and bank
+// (with the rotation and swizzle undone) then tell which micro tile of the
+// macro tile the address is in.
+void R600AddrLib::ComputeSurfaceCoordFromAddrMacroTiled(
+    u64 addr,
+    u32 bitPosition,
+    u32 bpp,
+    u32 pitch,
+    u32 height,
+    u32 numSamples,
+    AddrTileMode tileMode,
+    bool isDepthSampleOrder,
+    u32 tileBase,
+    u32 compBits,
+    u32 pipeSwizzle,
+    u32 bankSwizzle,
+    u32* pX,
+    u32* pY,
+    u32* pSlice,
+    u32* pSample
+)
+{
+    u32 numPipes = 2;
+    u32 numBanks = 4;
+
+    u32 numGroupBits = Log2(256u);
+    u32 numPipeBits = Log2(numPipes);
+    u32 numBankBits = Log2(numBanks);
+
+    u32 microTileThickness = ComputeSurfaceThickness(tileMode);
+
+    u32 microTileBits = 64 * microTileThickness * bpp * numSamples;
+    u32 microTileBytes = microTileBits / 8;
+
+    u32 samplesPerSplit;
+    u32 slicesPerTile;
+    u32 tileBits;
+
+    if (numSamples > 1 && microTileBytes > 2048u)
+    {
+        samplesPerSplit = 2048u / (microTileBytes / numSamples);
+        slicesPerTile = numSamples / samplesPerSplit;
+        tileBits = microTileBits / slicesPerTile;
+    }
+    else
+    {
+        samplesPerSplit = numSamples;
+        slicesPerTile = 1;
+        tileBits = microTileBits;
+    }
+
+    u32 pipe = (u32)(addr >> numGroupBits) & (numPipes - 1);
+    u32 bank = (u32)(addr >> (numGroupBits + numPipeBits)) & (numBanks - 1);
+
+    u64 groupMask = (1 << numGroupBits) - 1;
+    u64 totalOffset = (addr & groupMask) | ((addr >> (numPipeBits + numBankBits)) & ~groupMask);
+
+    u32 macroTilePitch = numBanks * 8;
+    u32 macroTileHeight = numPipes * 8;
+
+    switch (tileMode)
+    {
+    case ADDR_TM_2D_TILED_THIN2:
+    case ADDR_TM_2B_TILED_THIN2:
+        macroTilePitch /= 2;
+        macroTileHeight *= 2;
+        break;
+    case ADDR_TM_2D_TILED_THIN4:
+    case ADDR_TM_2B_TILED_THIN4:
+        macroTilePitch /= 4;
+        macroTileHeight *= 4;
+    }
+
+    u64 sliceBytes = ((u64)pitch * height * microTileThickness * bpp * samplesPerSplit + 7) / 8;
+
+    u32 macroTileBytes = (macroTilePitch * macroTileHeight * bpp * microTileThickness
+                          * samplesPerSplit + 7) / 8;
+
+    u32 macroTilesPerRow = pitch / macroTilePitch;
+    u64 macroTilesPerSlice = sliceBytes / macroTileBytes;
+
+    // Slice and macro tile offsets are multiples of the macro tile size,
+    // which is (1 << (numPipeBits + numBankBits)) times the size of what
+    // the element offset can span
+    u32 elementSpan = macroTileBytes >> (numPipeBits + numBankBits);
+
+    u64 macroTileIndex = totalOffset / elementSpan;
+    u32 elementOffset = (u32)(totalOffset % elementSpan) * 8 + bitPosition;
+
+    u32 sliceIndex = (u32)(macroTileIndex / macroTilesPerSlice);
+    macroTileIndex %= macroTilesPerSlice;
+
+    u32 macroTileIndexX = (u32)(macroTileIndex % macroTilesPerRow);
+    u32 macroTileIndexY = (u32)(macroTileIndex / macroTilesPerRow);
+
+    u32 slice = sliceIndex * microTileThickness / slicesPerTile;
+    u32 tileSplitSlice = sliceIndex * microTileThickness % slicesPerTile;
+
+    elementOffset += tileSplitSlice * tileBits;
+
+    u32 sample;
+    u32 pixelIndex;
+
+    if (isDepthSampleOrder)
+    {
+        if (compBits != 0 && compBits != bpp)
+        {
+            sample = ((elementOffset - tileBase) / compBits) % numSamples;
+            pixelIndex = (elementOffset - tileBase) / (compBits * numSamples);
+        }
+        else
+        {
+            sample = (elementOffset / bpp) % numSamples;
+            pixelIndex = elementOffset / (bpp * numSamples);
+        }
+    }
+    else
+    {
+        sample = elementOffset / (microTileBits / numSamples);
+        pixelIndex = (elementOffset % (microTileBits / numSamples)) / bpp;
+    }
+
+    u32 pixelX, pixelY, pixelZ;
+    ComputePixelCoordFromOffset(pixelIndex,
+                                bpp,
+                                tileMode,
+                                (AddrTileType)isDepthSampleOrder,
+                                &pixelX,
+                                &pixelY,
+                                &pixelZ);
+
+    slice += pixelZ;
+
+    if (tileMode == ADDR_TM_2B_TILED_THIN1 ||
+        tileMode == ADDR_TM_2B_TILED_THIN2 ||
+        tileMode == ADDR_TM_2B_TILED_THIN4 ||
+        tileMode == ADDR_TM_2B_TILED_THICK ||
+        tileMode == ADDR_TM_3B_TILED_THIN1 ||
+        tileMode == ADDR_TM_3B_TILED_THICK)
+    {
+        static const u32 bankSwapOrder[] = { 0, 1, 3, 2, 6, 7, 5, 4 };
+        u32 bankSwapWidth = ComputeSurfaceBankSwappedWidth(tileMode, bpp, samplesPerSplit, pitch, NULL);
+        bank ^= bankSwapOrder[((macroTileIndexX * macroTilePitch) / bankSwapWidth) % numBanks];
+    }
+
+    u32 bankPipeRotation = ComputeSurfaceRotationFromTileMode(tileMode);
+    u32 bankPipeSwizzle = bankSwizzle * numPipes + pipeSwizzle;
+
+    u32 microTileIndexZ = slice;
+    if (IsThickMacroTiled(tileMode))
+    {
+        microTileIndexZ /= 4;
+    }
+
+    u32 bankPipe = bank * numPipes + pipe;
+    bankPipe ^= bankPipeRotation * microTileIndexZ + bankPipeSwizzle;
+    bankPipe ^= tileSplitSlice * ((numBanks / 2) + 1) * numPipes;
+    bankPipe %= numBanks * numPipes;
+
+    // Find the micro tile of the macro tile with that (unrotated) bank/pipe
+    u32 macroTileX = macroTileIndexX * macroTilePitch;
+    u32 macroTileY = macroTileIndexY * macroTileHeight;
+
+    u32 microTileX = macroTileX;
+    u32 microTileY = macroTileY;
+
+    for (u32 y = macroTileY; y < macroTileY + macroTileHeight; y += 8)
+    {
+        for (u32 x = macroTileX; x < macroTileX + macroTilePitch; x += 8)
+        {
+            if (ComputeBankFromCoordWoRotation(x, y) * numPipes +
+                ComputePipeFromCoordWoRotation(x, y) == bankPipe)
+            {
+                microTileX = x;
+                microTileY = y;
+            }
+        }
+    }
+
+    *pX = microTileX + pixelX;
+    *pY = microTileY + pixelY;
+    *pSlice = slice;
+    *pSample = sample;
+}
+
+void R600AddrLib::ComputeSurfaceCoordFromAddr(
+    const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+    ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+)
+{
+    u64 addr = pIn->addr;
+    u32 bitPosition = pIn->bitPosition;
+    u32 bpp = pIn->bpp;
+    u32 pitch = pIn->pitch;
+    u32 height = pIn->height;
+    u32 numSlices = pIn->numSlices;
+    u32 numSamples = (pIn->numSamples == 0) ? 1 : pIn->numSamples;
+    AddrTileMode tileMode = pIn->tileMode;
+    bool isDepthSampleOrder = pIn->isDepth;
+    u32 tileBase = pIn->tileBase;
+    u32 compBits = pIn->compBits;
+    u32 pipeSwizzle = pIn->pipeSwizzle;
+    u32 bankSwizzle = pIn->bankSwizzle;
+
+    pOut->sample = 0;
+
+    switch (tileMode)
+    {
+    case ADDR_TM_LINEAR_GENERAL:
+    case ADDR_TM_LINEAR_ALIGNED:
+        ComputeSurfaceCoordFromAddrLinear(addr,
+                                          bitPosition,
+                                          bpp,
+                                          pitch,
+                                          height,
+                                          numSlices,
+                                          &pOut->x,
+                                          &pOut->y,
+                                          &pOut->slice,
+                                          &pOut->sample);
+        break;
+    case ADDR_TM_1D_TILED_THIN1:
+    case ADDR_TM_1D_TILED_THICK:
+        ComputeSurfaceCoordFromAddrMicroTiled(addr,
+                                              bitPosition,
+                                              bpp,
+                                              pitch,
+                                              height,
+                                              tileMode,
+                                              isDepthSampleOrder,
+                                              tileBase,
+                                              compBits,
+                                              &pOut->x,
+                                              &pOut->y,
+                                              &pOut->slice);
+        break;
+    case ADDR_TM_2D_TILED_THIN1:
+    case ADDR_TM_2D_TILED_THIN2:
+    case ADDR_TM_2D_TILED_THIN4:
+    case ADDR_TM_2D_TILED_THICK:
+    case ADDR_TM_2B_TILED_THIN1:
+    case ADDR_TM_2B_TILED_THIN2:
+    case ADDR_TM_2B_TILED_THIN4:
+    case ADDR_TM_2B_TILED_THICK:
+    case ADDR_TM_3D_TILED_THIN1:
+    case ADDR_TM_3D_TILED_THICK:
+    case ADDR_TM_3B_TILED_THIN1:
+    case ADDR_TM_3B_TILED_THICK:
+        ComputeSurfaceCoordFromAddrMacroTiled(addr,
+                                              bitPosition,
+                                              bpp,
+                                              pitch,
+                                              height,
+                                              numSamples,
+                                              tileMode,
+                                              isDepthSampleOrder,
+                                              tileBase,
+                                              compBits,
+                                              pipeSwizzle,
+                                              bankSwizzle,
+                                              &pOut->x,
+                                              &pOut->y,
+                                              &pOut->slice,
+                                              &pOut->sample);
+        break;
+    default:
+        pOut->x = 0;
+        pOut->y = 0;
+        pOut->slice = 0;
+    }
+}
+
 ADDR_E_RETURNCODE R600AddrLib::HwlComputeSurfaceInfo(
     const ADDR_COMPUTE_SURFACE_INFO_INPUT* pIn,
     ADDR_COMPUTE_SURFACE_INFO_OUTPUT* pOut
@@ -2146,6 +2703,382 @@ ADDR_E_RETURNCODE R600AddrLib::HwlComputeSurfaceAddrFromCoord(
     return retCode;
 }
 
+ADDR_E_RETURNCODE R600AddrLib::HwlComputeSurfaceCoordFromAddr(
+    const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+    ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+)
+{
+    ADDR_E_RETURNCODE retCode = ADDR_OK;
+    if (pIn->pipeSwizzle >= 2 ||
+        pIn->bankSwizzle >= 4 ||
+        pIn->bpp == 0         ||
+        pIn->pitch == 0       ||
+        pIn->height == 0      ||
+        pIn->numSamples > 8)
+    {
+        retCode = ADDR_INVALIDPARAMS;
+    }
+    else
+    {
+        ComputeSurfaceCoordFromAddr(pIn, pOut);
+    }
+
+    return retCode;
+}
+
+ADDR_E_RETURNCODE R600AddrLib::ComputeSurfaceMicroTileOffsets(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    u32* pOffsets
+)
+{
+    u32 numPipes = 2;
+    u32 numBanks = 4;
+
+    u32 numGroupBits = Log2(256u);
+    u32 numPipeBits = Log2(numPipes);
+    u32 numBankBits = Log2(numBanks);
+
+    u32 slice = pIn->slice;
+    u32 bpp = pIn->bpp;
+    u32 pitch = pIn->pitch;
+    u32 numSamples = (pIn->numSamples == 0) ? 1 : pIn->numSamples;
+    AddrTileMode tileMode = pIn->tileMode;
+    bool isDepthSampleOrder = pIn->isDepth;
+    AddrTileType microTileType = (AddrTileType)isDepthSampleOrder;
+
+    // Offsets are only a function of the position within the micro tile
+    // for single-sampled surfaces with byte-aligned elements
+    if (bpp == 0 || bpp % 8 != 0 || numSamples != 1 ||
+        pIn->pipeSwizzle >= 2 || pIn->bankSwizzle >= 4 ||
+        (isDepthSampleOrder && pIn->compBits != 0 && pIn->compBits != bpp))
+    {
+        return ADDR_NOTSUPPORTED;
+    }
+
+    u32 bytesPerElem = bpp / 8;
+
+    switch (tileMode)
+    {
+    case ADDR_TM_LINEAR_GENERAL:
+    case ADDR_TM_LINEAR_ALIGNED:
+        for (u32 y = 0; y < 8; y++)
+            for (u32 x = 0; x < 8; x++)
+                pOffsets[y * 8 + x] = (y * pitch + x) * bytesPerElem;
+
+        break;
+    case ADDR_TM_1D_TILED_THIN1:
+    case ADDR_TM_1D_TILED_THICK:
+    {
+        u32 originIndex = ComputePixelIndexWithinMicroTile(0, 0, slice, bpp, tileMode, microTileType);
+
+        for (u32 y = 0; y < 8; y++)
+            for (u32 x = 0; x < 8; x++)
+                pOffsets[y * 8 + x] = (ComputePixelIndexWithinMicroTile(x, y, slice, bpp, tileMode, microTileType)
+                                       - originIndex) * bytesPerElem;
+
+        break;
+    }
+    case ADDR_TM_2D_TILED_THIN1:
+    case ADDR_TM_2D_TILED_THIN2:
+    case ADDR_TM_2D_TILED_THIN4:
+    case ADDR_TM_2D_TILED_THICK:
+    case ADDR_TM_2B_TILED_THIN1:
+    case ADDR_TM_2B_TILED_THIN2:
+    case ADDR_TM_2B_TILED_THIN4:
+    case ADDR_TM_2B_TILED_THICK:
+    case ADDR_TM_3D_TILED_THIN1:
+    case ADDR_TM_3D_TILED_THICK:
+    case ADDR_TM_3B_TILED_THIN1:
+    case ADDR_TM_3B_TILED_THICK:
+    {
+        // The offset of a micro tile within its slice is a multiple of the
+        // micro tile size, so as long as that is a power of two, the element
+        // offset never carries into it and the pipe/bank interleave can be
+        // applied to the element offset on its own
+        u32 microTileBytes = 64 * ComputeSurfaceThickness(tileMode) * bytesPerElem;
+        if (!IsPow2(microTileBytes))
+            return ADDR_NOTSUPPORTED;
+
+        u32 groupMask = (1 << numGroupBits) - 1;
+        u32 originOffset = ComputePixelIndexWithinMicroTile(0, 0, slice, bpp, tileMode, microTileType)
+                           * bytesPerElem;
+
+        for (u32 y = 0; y < 8; y++)
+        {
+            for (u32 x = 0; x < 8; x++)
+            {
+                u32 elementOffset = ComputePixelIndexWithinMicroTile(x, y, slice, bpp, tileMode, microTileType)
+                                    * bytesPerElem - originOffset;
+
+                pOffsets[y * 8 + x] =  (elementOffset &  groupMask) |
+                                      ((elementOffset & ~groupMask) << (numPipeBits + numBankBits));
+            }
+        }
+
+        break;
+    }
+    default:
+        return ADDR_NOTSUPPORTED;
+    }
+
+    return ADDR_OK;
+}
+
+// Everything needed to resolve addresses within one slice of a single
+// sampled surface with byte-aligned elements, as
+//   addr(x, y) = microTileAddr(x >> 3, y >> 3) + microTileOffs[(y & 7) * 8 + (x & 7)]
+// where microTileAddr is either
+//   base + (y >> 3) * microTileRowStride + (x >> 3) * microTileStride
+// (linear and micro tiled modes), or the macro tiled address of the micro
+// tile's origin (computed in 32 bits)
+struct AddrBatchParams
+{
+    bool macroTiled;
+    u32  microTileOffs[64];
+
+    // Linear and micro tiled
+    u64  base;
+    u32  microTileRowStride;
+    u32  microTileStride;
+
+    // Macro tiled
+    u32  macroTilePitchShift;
+    u32  macroTileHeightShift;
+    u32  macroTilesPerRow;
+    u32  macroTileBytes;
+    u32  sliceOffset;
+    u32  originElemOffset;
+    u32  bankPipeXor;
+};
+
+static inline u64 AddrBatchComputeAddr(const AddrBatchParams& params, u32 x, u32 y)
+{
+    u32 microTileOffset = params.microTileOffs[(y & 7) * 8 + (x & 7)];
+
+    if (!params.macroTiled)
+        return params.base + (u64)(y >> 3) * params.microTileRowStride
+                           + (u64)(x >> 3) * params.microTileStride
+                           + microTileOffset;
+
+    u32 pipe = (x ^ y) >> 3 & 1;
+    u32 bank = ((x >> 4 ^ y >> 4) & 1) << 1 | ((x >> 3 ^ y >> 5) & 1);
+    u32 bankPipe = ((bank << 1 | pipe) ^ params.bankPipeXor) & 7;
+
+    u32 macroTileOffset = ((y >> params.macroTileHeightShift) * params.macroTilesPerRow +
+                           (x >> params.macroTilePitchShift)) * params.macroTileBytes;
+
+    u32 totalOffset = ((params.sliceOffset + macroTileOffset) >> 3) + params.originElemOffset;
+
+    return ((totalOffset & 0xFF) | (totalOffset & ~0xFFu) << 3 | bankPipe << 8) + microTileOffset;
+}
+
+#if defined(CPU_FEATURES_ARCH_X86)
+
+static CPU_FEATURES_TARGET_AVX2 u32 AddrBatchComputeAddrMacroTiledAVX2(
+    const AddrBatchParams& params,
+    u32 count,
+    const u32* pX,
+    const u32* pY,
+    u64* pAddr
+)
+{
+    const __m256i one          = _mm256_set1_epi32(1);
+    const __m256i seven        = _mm256_set1_epi32(7);
+    const __m256i groupMask    = _mm256_set1_epi32(0xFF);
+    const __m256i bankPipeXor  = _mm256_set1_epi32(params.bankPipeXor);
+    const __m256i tilesPerRow  = _mm256_set1_epi32(params.macroTilesPerRow);
+    const __m256i tileBytes    = _mm256_set1_epi32(params.macroTileBytes);
+    const __m256i sliceOffset  = _mm256_set1_epi32(params.sliceOffset);
+    const __m256i originOffset = _mm256_set1_epi32(params.originElemOffset);
+    const __m128i pitchShift   = _mm_cvtsi32_si128(params.macroTilePitchShift);
+    const __m128i heightShift  = _mm_cvtsi32_si128(params.macroTileHeightShift);
+
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(pX + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(pY + i));
+
+        __m256i pipe = _mm256_and_si256(_mm256_srli_epi32(_mm256_xor_si256(x, y), 3), one);
+        __m256i bank0 = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi32(x, 3), _mm256_srli_epi32(y, 5)), one);
+        __m256i bank1 = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi32(x, 4), _mm256_srli_epi32(y, 4)), one);
+        __m256i bankPipe = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(bank1, 2), _mm256_slli_epi32(bank0, 1)), pipe);
+        bankPipe = _mm256_and_si256(_mm256_xor_si256(bankPipe, bankPipeXor), seven);
+
+        __m256i macroTileOffset = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srl_epi32(y, heightShift), tilesPerRow),
+                                                   _mm256_srl_epi32(x, pitchShift));
+        macroTileOffset = _mm256_mullo_epi32(macroTileOffset, tileBytes);
+
+        __m256i totalOffset = _mm256_add_epi32(_mm256_srli_epi32(_mm256_add_epi32(sliceOffset, macroTileOffset), 3),
+                                               originOffset);
+
+        __m256i addr = _mm256_or_si256(_mm256_and_si256(totalOffset, groupMask),
+                                       _mm256_slli_epi32(_mm256_andnot_si256(groupMask, totalOffset), 3));
+        addr = _mm256_or_si256(addr, _mm256_slli_epi32(bankPipe, 8));
+
+        __m256i index = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(y, seven), 3),
+                                        _mm256_and_si256(x, seven));
+        addr = _mm256_add_epi32(addr, _mm256_i32gather_epi32((const int*)params.microTileOffs, index, 4));
+
+        _mm256_storeu_si256((__m256i*)(pAddr + i),     _mm256_cvtepu32_epi64(_mm256_castsi256_si128(addr)));
+        _mm256_storeu_si256((__m256i*)(pAddr + i + 4), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(addr, 1)));
+    }
+
+    return i;
+}
+
+#endif
+
+ADDR_E_RETURNCODE R600AddrLib::ComputeSurfaceAddrFromCoordBatch(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    u32 count,
+    const u32* pX,
+    const u32* pY,
+    const u32* pSlice,
+    const u32* pSample,
+    u64* pAddr,
+    u32* pBitPosition
+)
+{
+    if (pIn->pipeSwizzle >= 2 ||
+        pIn->bankSwizzle >= 4 ||
+        pIn->numSamples > 8)
+    {
+        return ADDR_INVALIDPARAMS;
+    }
+
+    u32 numPipes = 2;
+    u32 numBanks = 4;
+
+    u32 slice = pIn->slice;
+    u32 bpp = pIn->bpp;
+    u32 pitch = pIn->pitch;
+    u32 height = pIn->height;
+    AddrTileMode tileMode = pIn->tileMode;
+
+    // Shared slice and sample, and single sampled surface with byte-aligned
+    // elements (see ComputeSurfaceMicroTileOffsets)
+    AddrBatchParams params;
+    bool useParams = pSlice == NULL && pSample == NULL && pIn->sample == 0 &&
+                     ComputeSurfaceMicroTileOffsets(pIn, params.microTileOffs) == ADDR_OK;
+
+    if (useParams)
+    {
+        u32 bytesPerElem = bpp / 8;
+        u32 microTileThickness = ComputeSurfaceThickness(tileMode);
+
+        switch (tileMode)
+        {
+        case ADDR_TM_LINEAR_GENERAL:
+        case ADDR_TM_LINEAR_ALIGNED:
+        case ADDR_TM_1D_TILED_THIN1:
+        case ADDR_TM_1D_TILED_THICK:
+        {
+            ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT originIn = *pIn;
+            originIn.x = 0;
+            originIn.y = 0;
+
+            u32 bitPosition;
+
+            params.macroTiled = false;
+            params.base = ComputeSurfaceAddrFromCoordGeneric(&originIn, &bitPosition);
+
+            if (tileMode == ADDR_TM_LINEAR_GENERAL || tileMode == ADDR_TM_LINEAR_ALIGNED)
+            {
+                params.microTileRowStride = 8 * pitch * bytesPerElem;
+                params.microTileStride = 8 * bytesPerElem;
+            }
+            else
+            {
+                u32 microTileBytes = 64 * microTileThickness * bytesPerElem;
+                params.microTileRowStride = (pitch / 8) * microTileBytes;
+                params.microTileStride = microTileBytes;
+            }
+
+            break;
+        }
+        case ADDR_TM_2D_TILED_THIN1:
+        case ADDR_TM_2D_TILED_THIN2:
+        case ADDR_TM_2D_TILED_THIN4:
+        case ADDR_TM_2D_TILED_THICK:
+        case ADDR_TM_3D_TILED_THIN1:
+        case ADDR_TM_3D_TILED_THICK:
+        {
+            // Same as ComputeSurfaceAddrFromCoordMacroTiled, for the origin
+            // of a micro tile (bank swapped modes are left to it)
+            u32 macroTilePitch = numBanks * 8 / ComputeMacroTileAspectRatio(tileMode);
+            u32 macroTileHeight = numPipes * 8 * ComputeMacroTileAspectRatio(tileMode);
+
+            u64 sliceBytes = (u64)pitch * height * microTileThickness * bytesPerElem;
+            u64 sliceOffset = sliceBytes * (slice / microTileThickness);
+
+            u32 microTileIndexZ = slice;
+            if (IsThickMacroTiled(tileMode))
+                microTileIndexZ /= 4;
+
+            params.macroTiled = true;
+            params.macroTilePitchShift = Log2(macroTilePitch);
+            params.macroTileHeightShift = Log2(macroTileHeight);
+            params.macroTilesPerRow = pitch / macroTilePitch;
+            params.macroTileBytes = macroTilePitch * macroTileHeight * microTileThickness * bytesPerElem;
+            params.sliceOffset = (u32)sliceOffset;
+            params.originElemOffset = ComputePixelIndexWithinMicroTile(0, 0, slice, bpp, tileMode,
+                                                                       (AddrTileType)pIn->isDepth) * bytesPerElem;
+            params.bankPipeXor = (ComputeSurfaceRotationFromTileMode(tileMode) * microTileIndexZ +
+                                  pIn->bankSwizzle * numPipes + pIn->pipeSwizzle) % (numBanks * numPipes);
+
+            // The computation is done in 32 bits
+            useParams = sliceOffset + sliceBytes <= 0xFFFFFFFFu;
+            break;
+        }
+        default:
+            useParams = false;
+        }
+    }
+
+    if (useParams)
+    {
+        u32 i = 0;
+
+#if defined(CPU_FEATURES_ARCH_X86)
+        if (params.macroTiled && (CPUFeatures_Get() & CPU_FEATURE_AVX2))
+            i = AddrBatchComputeAddrMacroTiledAVX2(params, count, pX, pY, pAddr);
+#endif
+
+        for (; i < count; i++)
+            pAddr[i] = AddrBatchComputeAddr(params, pX[i], pY[i]);
+
+        if (pBitPosition != NULL)
+            for (i = 0; i < count; i++)
+                pBitPosition[i] = 0;
+    }
+    else
+    {
+        ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT in = *pIn;
+        ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC computeAddr = GetSurfaceAddrFromCoordFunc(&in);
+
+        for (u32 i = 0; i < count; i++)
+        {
+            in.x = pX[i];
+            in.y = pY[i];
+
+            if (pSlice != NULL)
+                in.slice = pSlice[i];
+
+            if (pSample != NULL)
+                in.sample = pSample[i];
+
+            u32 bitPosition;
+            pAddr[i] = computeAddr(&in, &bitPosition);
+
+            if (pBitPosition != NULL)
+                pBitPosition[i] = bitPosition;
+        }
+    }
+
+    return ADDR_OK;
+}
+
 bool R600AddrLib::HwlComputeMipLevel(
     u32* pWidth,
     u32* pHeight,
@@ -2211,6 +3144,43 @@ ADDR_E_RETURNCODE AddrComputeSurfaceAddrFromCoord(
     return AddrLib::ComputeSurfaceAddrFromCoord(pIn, pOut);
 }
 
+ADDR_E_RETURNCODE AddrComputeSurfaceCoordFromAddr(
+    const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT* pIn,
+    ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut
+)
+{
+    return AddrLib::ComputeSurfaceCoordFromAddr(pIn, pOut);
+}
+
+ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_FUNC AddrGetSurfaceAddrFromCoordFunc(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn
+)
+{
+    return R600AddrLib::GetSurfaceAddrFromCoordFunc(pIn);
+}
+
+ADDR_E_RETURNCODE AddrComputeSurfaceAddrFromCoordBatch(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    u32 count,
+    const u32* pX,
+    const u32* pY,
+    const u32* pSlice,
+    const u32* pSample,
+    u64* pAddr,
+    u32* pBitPosition
+)
+{
+    return R600AddrLib::ComputeSurfaceAddrFromCoordBatch(pIn, count, pX, pY, pSlice, pSample, pAddr, pBitPosition);
+}
+
+ADDR_E_RETURNCODE AddrComputeSurfaceMicroTileOffsets(
+    const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
+    u32* pOffsets
+)
+{
+    return R600AddrLib::ComputeSurfaceMicroTileOffsets(pIn, pOffsets);
+}
+
 }
 
 #ifdef __GNUC__
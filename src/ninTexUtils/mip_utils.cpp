@@ -0,0 +1,579 @@
+#include <ninTexUtils/mip_utils.h>
+#include <ninTexUtils/cpu_features.h>
+#include <ninTexUtils/thread_pool.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define TEX_MIP_UTILS_KERNELS_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define TEX_MIP_UTILS_KERNELS_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// sRGB transfer functions
+
+static inline f32 srgb_decode(f32 v)
+{
+    return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+static inline f32 srgb_encode(f32 v)
+{
+    return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+}
+
+// Linear values of the 256 sRGB-encoded values
+static const f32* get_srgb_to_linear_table()
+{
+    static const std::array<f32, 256> table = []
+    {
+        std::array<f32, 256> t;
+        for (u32 i = 0; i < 256; i++)
+            t[i] = srgb_decode(i / 255.0f);
+        return t;
+    }();
+
+    return table.data();
+}
+
+// Values of the 256 unorm values
+static const f32* get_unorm_to_float_table()
+{
+    static const std::array<f32, 256> table = []
+    {
+        std::array<f32, 256> t;
+        for (u32 i = 0; i < 256; i++)
+            t[i] = i / 255.0f;
+        return t;
+    }();
+
+    return table.data();
+}
+
+// sRGB-encoded values of linear values quantized to 16 bits, which is fine
+// enough for the darkest sRGB values (where the encoding is the steepest)
+#define TEX_MIP_UTILS_LINEAR_TO_SRGB_SIZE 0x10000
+
+static const u8* get_linear_to_srgb_table()
+{
+    static const std::vector<u8> table = []
+    {
+        std::vector<u8> t(TEX_MIP_UTILS_LINEAR_TO_SRGB_SIZE);
+        for (u32 i = 0; i < TEX_MIP_UTILS_LINEAR_TO_SRGB_SIZE; i++)
+            t[i] = (u8)(srgb_encode(i / (f32)(TEX_MIP_UTILS_LINEAR_TO_SRGB_SIZE - 1)) * 255.0f + 0.5f);
+        return t;
+    }();
+
+    return table.data();
+}
+
+static inline f32 clamp_unorm(f32 v)
+{
+    return v < 0.0f ? 0.0f : v > 1.0f ? 1.0f : v;
+}
+
+// Filter taps.
+// Each destination texel along a dimension is a weighted sum of num_taps
+// consecutive source texels, starting at first[i]. Taps falling outside of
+// the image have their weights moved to the edge texel.
+
+struct TexMipUtilsTaps
+{
+    u32 src_size;
+    u32 dst_size;
+    TexMipUtilsFilter filter;
+    u32 num_taps;
+    std::vector<u32> first;
+    std::vector<f32> weights;   // num_taps per destination texel
+};
+
+// Modified Bessel function of the first kind, order 0
+static f32 bessel_i0(f32 x)
+{
+    const f32 y = x * x / 4.0f;
+
+    f32 sum = 1.0f;
+    f32 term = 1.0f;
+
+    for (u32 k = 1; k < 32; k++)
+    {
+        term *= y / (f32)(k * k);
+        sum += term;
+
+        if (term < sum * 1e-8f)
+            break;
+    }
+
+    return sum;
+}
+
+// Sinc windowed by a Kaiser window, x in destination texels
+static f32 kaiser_sinc(f32 x)
+{
+    const f32 lobes = 3.0f;
+    const f32 alpha = 4.0f;
+    const f32 pi = 3.14159265358979f;
+
+    if (std::fabs(x) >= lobes)
+        return 0.0f;
+
+    const f32 t = x / lobes;
+    const f32 window = bessel_i0(alpha * std::sqrt(1.0f - t * t)) / bessel_i0(alpha);
+    const f32 sinc = x == 0.0f ? 1.0f : std::sin(pi * x) / (pi * x);
+
+    return sinc * window;
+}
+
+static void build_taps(u32 src_size, u32 dst_size, TexMipUtilsFilter filter, TexMipUtilsTaps* taps)
+{
+    assert(dst_size != 0 && dst_size <= src_size);
+
+    const f32 scale = (f32)src_size / (f32)dst_size;
+
+    // Half-width of the filter, in source texels
+    f32 radius = 0.5f;
+    if (src_size != dst_size)
+        radius = filter == TEX_MIP_UTILS_FILTER_KAISER ? 3.0f * scale : 0.5f * scale;
+
+    std::vector<u32> first(dst_size);
+    std::vector< std::vector<f32> > weights(dst_size);
+    u32 num_taps = 1;
+
+    for (u32 i = 0; i < dst_size; i++)
+    {
+        const f32 center = (i + 0.5f) * scale;
+        const s32 j_begin = (s32)std::floor(center - radius);
+        const s32 j_end = (s32)std::ceil(center + radius);
+
+        const s32 j_first = std::max(j_begin, 0);
+        const s32 j_last = std::min(j_end - 1, (s32)src_size - 1);
+
+        std::vector<f32>& w = weights[i];
+        w.assign(j_last - j_first + 1, 0.0f);
+
+        f32 sum = 0.0f;
+
+        for (s32 j = j_begin; j < j_end; j++)
+        {
+            f32 weight;
+            if (src_size == dst_size)
+                weight = j == (s32)i ? 1.0f : 0.0f;
+            else if (filter == TEX_MIP_UTILS_FILTER_KAISER)
+                weight = kaiser_sinc((j + 0.5f - center) / scale);
+            else
+                weight = std::max(std::min(j + 1.0f, center + radius) - std::max((f32)j, center - radius), 0.0f);
+
+            w[std::min(std::max(j, j_first), j_last) - j_first] += weight;
+            sum += weight;
+        }
+
+        for (f32& weight : w)
+            weight /= sum;
+
+        // Drop the taps of weight 0 at both ends
+        u32 lo = 0, hi = (u32)w.size();
+        while (hi - lo > 1 && w[lo] == 0.0f) lo++;
+        while (hi - lo > 1 && w[hi - 1] == 0.0f) hi--;
+
+        w = std::vector<f32>(w.begin() + lo, w.begin() + hi);
+        first[i] = j_first + lo;
+        num_taps = std::max(num_taps, (u32)w.size());
+    }
+
+    // Pad every texel to num_taps taps, keeping them within the image
+    taps->src_size = src_size;
+    taps->dst_size = dst_size;
+    taps->filter = filter;
+    taps->num_taps = num_taps;
+    taps->first.resize(dst_size);
+    taps->weights.assign((size_t)dst_size * num_taps, 0.0f);
+
+    for (u32 i = 0; i < dst_size; i++)
+    {
+        const u32 start = std::min(first[i], src_size - num_taps);
+        taps->first[i] = start;
+        std::copy(weights[i].begin(), weights[i].end(), taps->weights.begin() + (size_t)i * num_taps + (first[i] - start));
+    }
+}
+
+// Images filtered in bands (TexMipUtils_DownsampleRows) use the same taps
+// for every band, so the taps of the last few sizes are kept
+#define TEX_MIP_UTILS_TAPS_CACHE_SIZE 4
+
+static std::shared_ptr<const TexMipUtilsTaps> get_taps(u32 src_size, u32 dst_size, TexMipUtilsFilter filter)
+{
+    static std::mutex mutex;
+    static std::shared_ptr<const TexMipUtilsTaps> cache[TEX_MIP_UTILS_TAPS_CACHE_SIZE]; // Most recently used first
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (u32 i = 0; i < TEX_MIP_UTILS_TAPS_CACHE_SIZE && cache[i]; i++)
+        {
+            if (cache[i]->src_size == src_size && cache[i]->dst_size == dst_size && cache[i]->filter == filter)
+            {
+                std::rotate(cache, cache + i, cache + i + 1);
+                return cache[0];
+            }
+        }
+    }
+
+    // Build outside of the lock
+    std::shared_ptr<TexMipUtilsTaps> taps = std::make_shared<TexMipUtilsTaps>();
+    build_taps(src_size, dst_size, filter, taps.get());
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::rotate(cache, cache + TEX_MIP_UTILS_TAPS_CACHE_SIZE - 1, cache + TEX_MIP_UTILS_TAPS_CACHE_SIZE);
+    cache[0] = taps;
+    return taps;
+}
+
+// Filters a row of texels along x
+typedef void (*TexMipUtilsFilterRowFunc)(const f32* in_row, f32* out_row, const TexMipUtilsTaps* taps, u32 dst_width);
+
+// Filters rows along y: out_row is the sum of weights[t] * in_rows[t] over
+// the num_rows rows, num_floats components (a multiple of 4) each
+typedef void (*TexMipUtilsBlendRowsFunc)(const f32* const* in_rows, const f32* weights, u32 num_rows,
+                                         f32* out_row, u32 num_floats);
+
+// Generic kernels.
+// All kernels accumulate the taps in the same order, starting from 0, with
+// separate multiplies and adds, so their results are identical.
+
+static void filter_row_generic(const f32* in_row, f32* out_row, const TexMipUtilsTaps* taps, u32 dst_width)
+{
+    const u32 num_taps = taps->num_taps;
+
+    for (u32 x = 0; x < dst_width; x++)
+    {
+        const f32* in = in_row + (size_t)taps->first[x] * 4;
+        const f32* weights = &taps->weights[(size_t)x * num_taps];
+
+        f32 acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        for (u32 t = 0; t < num_taps; t++)
+            for (u32 c = 0; c < 4; c++)
+                acc[c] += weights[t] * in[t * 4 + c];
+
+        for (u32 c = 0; c < 4; c++)
+            out_row[x * 4 + c] = acc[c];
+    }
+}
+
+static void blend_rows_generic(const f32* const* in_rows, const f32* weights, u32 num_rows,
+                               f32* out_row, u32 num_floats)
+{
+    for (u32 i = 0; i < num_floats; i++)
+        out_row[i] = 0.0f;
+
+    for (u32 t = 0; t < num_rows; t++)
+        for (u32 i = 0; i < num_floats; i++)
+            out_row[i] += weights[t] * in_rows[t][i];
+}
+
+// SIMD kernels.
+// Rows are filtered one texel (4 components) per vector, columns as many
+// components per vector as fit.
+
+#if defined(TEX_MIP_UTILS_KERNELS_X86)
+
+static void filter_row_sse2(const f32* in_row, f32* out_row, const TexMipUtilsTaps* taps, u32 dst_width)
+{
+    const u32 num_taps = taps->num_taps;
+
+    for (u32 x = 0; x < dst_width; x++)
+    {
+        const f32* in = in_row + (size_t)taps->first[x] * 4;
+        const f32* weights = &taps->weights[(size_t)x * num_taps];
+
+        __m128 acc = _mm_setzero_ps();
+
+        for (u32 t = 0; t < num_taps; t++)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(in + t * 4)));
+
+        _mm_storeu_ps(out_row + x * 4, acc);
+    }
+}
+
+static void blend_rows_sse2(const f32* const* in_rows, const f32* weights, u32 num_rows,
+                            f32* out_row, u32 num_floats)
+{
+    for (u32 i = 0; i < num_floats; i += 4)
+    {
+        __m128 acc = _mm_setzero_ps();
+
+        for (u32 t = 0; t < num_rows; t++)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(in_rows[t] + i)));
+
+        _mm_storeu_ps(out_row + i, acc);
+    }
+}
+
+static CPU_FEATURES_TARGET_AVX2 void blend_rows_avx2(const f32* const* in_rows, const f32* weights, u32 num_rows,
+                                                     f32* out_row, u32 num_floats)
+{
+    u32 i = 0;
+
+    for (; i + 8 <= num_floats; i += 8)
+    {
+        __m256 acc = _mm256_setzero_ps();
+
+        for (u32 t = 0; t < num_rows; t++)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(weights[t]), _mm256_loadu_ps(in_rows[t] + i)));
+
+        _mm256_storeu_ps(out_row + i, acc);
+    }
+
+    if (i < num_floats)
+    {
+        __m128 acc = _mm_setzero_ps();
+
+        for (u32 t = 0; t < num_rows; t++)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(in_rows[t] + i)));
+
+        _mm_storeu_ps(out_row + i, acc);
+    }
+}
+
+#elif defined(TEX_MIP_UTILS_KERNELS_NEON)
+
+static void filter_row_neon(const f32* in_row, f32* out_row, const TexMipUtilsTaps* taps, u32 dst_width)
+{
+    const u32 num_taps = taps->num_taps;
+
+    for (u32 x = 0; x < dst_width; x++)
+    {
+        const f32* in = in_row + (size_t)taps->first[x] * 4;
+        const f32* weights = &taps->weights[(size_t)x * num_taps];
+
+        float32x4_t acc = vdupq_n_f32(0.0f);
+
+        for (u32 t = 0; t < num_taps; t++)
+            acc = vaddq_f32(acc, vmulq_n_f32(vld1q_f32(in + t * 4), weights[t]));
+
+        vst1q_f32(out_row + x * 4, acc);
+    }
+}
+
+static void blend_rows_neon(const f32* const* in_rows, const f32* weights, u32 num_rows,
+                            f32* out_row, u32 num_floats)
+{
+    for (u32 i = 0; i < num_floats; i += 4)
+    {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+
+        for (u32 t = 0; t < num_rows; t++)
+            acc = vaddq_f32(acc, vmulq_n_f32(vld1q_f32(in_rows[t] + i), weights[t]));
+
+        vst1q_f32(out_row + i, acc);
+    }
+}
+
+#endif
+
+static TexMipUtilsFilterRowFunc select_filter_row()
+{
+    const u32 features = CPUFeatures_Get();
+
+#if defined(TEX_MIP_UTILS_KERNELS_X86)
+    if (features & CPU_FEATURE_SSE2)
+        return filter_row_sse2;
+#elif defined(TEX_MIP_UTILS_KERNELS_NEON)
+    if (features & CPU_FEATURE_NEON)
+        return filter_row_neon;
+#endif
+
+    (void)features;
+    return filter_row_generic;
+}
+
+static TexMipUtilsBlendRowsFunc select_blend_rows()
+{
+    const u32 features = CPUFeatures_Get();
+
+#if defined(TEX_MIP_UTILS_KERNELS_X86)
+    if (features & CPU_FEATURE_AVX2)
+        return blend_rows_avx2;
+
+    if (features & CPU_FEATURE_SSE2)
+        return blend_rows_sse2;
+#elif defined(TEX_MIP_UTILS_KERNELS_NEON)
+    if (features & CPU_FEATURE_NEON)
+        return blend_rows_neon;
+#endif
+
+    (void)features;
+    return blend_rows_generic;
+}
+
+// Images are filtered in bands of rows of at least this many bytes of
+// output. Each band filters the source rows it needs along x into a buffer
+// of its own, then filters the buffer along y, so that the intermediate
+// rows stay in cache. Rows shared by two bands are filtered by both.
+#define TEX_MIP_UTILS_MIN_BAND_SIZE 0x40000
+
+struct TexMipUtilsDownsampleJob
+{
+    u32 src_width;
+    u32 src_y;              // Source row of in_data
+    u32 dst_width;
+    u32 dst_y;              // Destination row of out_data
+    u32 dst_rows;
+    const f32* in_data;
+    f32* out_data;
+
+    std::shared_ptr<const TexMipUtilsTaps> taps_x;
+    std::shared_ptr<const TexMipUtilsTaps> taps_y;
+    TexMipUtilsFilterRowFunc filter_row;
+    TexMipUtilsBlendRowsFunc blend_rows;
+
+    u32 rows_per_band;
+};
+
+static void downsample_band(void* user_data, u32 index)
+{
+    const TexMipUtilsDownsampleJob* job = (const TexMipUtilsDownsampleJob*)user_data;
+    const TexMipUtilsTaps& taps_y = *job->taps_y;
+
+    const u32 num_taps = taps_y.num_taps;
+    const size_t src_row_size = (size_t)job->src_width * 4;
+    const size_t dst_row_size = (size_t)job->dst_width * 4;
+
+    const u32 y_begin = job->dst_y + index * job->rows_per_band;
+    const u32 y_end = std::min(y_begin + job->rows_per_band, job->dst_y + job->dst_rows);
+
+    // Source rows used by the band
+    const u32 row_begin = taps_y.first[y_begin];
+    const u32 row_end = taps_y.first[y_end - 1] + num_taps;
+
+    assert(row_begin >= job->src_y);
+
+    // Rows filtered along x (or the source rows, if the width is unchanged)
+    std::vector<f32> tmp_data;
+    const f32* rows_data = job->in_data + (row_begin - job->src_y) * src_row_size;
+
+    if (job->src_width != job->dst_width)
+    {
+        tmp_data.resize((row_end - row_begin) * dst_row_size);
+
+        for (u32 row = row_begin; row < row_end; row++)
+            job->filter_row(job->in_data + (row - job->src_y) * src_row_size,
+                            tmp_data.data() + (row - row_begin) * dst_row_size,
+                            job->taps_x.get(), job->dst_width);
+
+        rows_data = tmp_data.data();
+    }
+
+    std::vector<const f32*> in_rows(num_taps);
+
+    for (u32 y = y_begin; y < y_end; y++)
+    {
+        for (u32 t = 0; t < num_taps; t++)
+            in_rows[t] = rows_data + (taps_y.first[y] + t - row_begin) * dst_row_size;
+
+        job->blend_rows(in_rows.data(), &taps_y.weights[(size_t)y * num_taps], num_taps,
+                        job->out_data + (y - job->dst_y) * dst_row_size, (u32)dst_row_size);
+    }
+}
+
+extern "C"
+{
+
+void TexMipUtils_RGBA8ToFloat(u32 num_pixels, const u8* in_data, f32* out_data, bool srgb)
+{
+    const f32* unorm_to_float = get_unorm_to_float_table();
+    const f32* rgb_to_float = srgb ? get_srgb_to_linear_table() : unorm_to_float;
+
+    for (size_t i = 0; i < (size_t)num_pixels * 4; i += 4)
+    {
+        out_data[i + 0] = rgb_to_float[in_data[i + 0]];
+        out_data[i + 1] = rgb_to_float[in_data[i + 1]];
+        out_data[i + 2] = rgb_to_float[in_data[i + 2]];
+        out_data[i + 3] = unorm_to_float[in_data[i + 3]];
+    }
+}
+
+void TexMipUtils_FloatToRGBA8(u32 num_pixels, const f32* in_data, u8* out_data, bool srgb)
+{
+    const u8* linear_to_srgb = srgb ? get_linear_to_srgb_table() : nullptr;
+
+    for (size_t i = 0; i < (size_t)num_pixels * 4; i += 4)
+    {
+        for (u32 c = 0; c < 3; c++)
+        {
+            const f32 v = clamp_unorm(in_data[i + c]);
+            out_data[i + c] = srgb ? linear_to_srgb[(u32)(v * (TEX_MIP_UTILS_LINEAR_TO_SRGB_SIZE - 1) + 0.5f)]
+                                   : (u8)(v * 255.0f + 0.5f);
+        }
+
+        out_data[i + 3] = (u8)(clamp_unorm(in_data[i + 3]) * 255.0f + 0.5f);
+    }
+}
+
+void TexMipUtils_Downsample(u32 src_width, u32 src_height, const f32* in_data,
+                            u32 dst_width, u32 dst_height, f32* out_data,
+                            TexMipUtilsFilter filter)
+{
+    TexMipUtils_DownsampleRows(src_width, src_height, 0, in_data,
+                               dst_width, dst_height, 0, dst_height, out_data, filter);
+}
+
+void TexMipUtils_GetDownsampleSourceRows(u32 src_height, u32 dst_height, u32 dst_y, u32 dst_rows,
+                                         TexMipUtilsFilter filter, u32* src_row_begin, u32* src_row_end)
+{
+    assert(dst_height <= src_height);
+    assert(dst_rows <= dst_height && dst_y <= dst_height - dst_rows);
+
+    if (dst_rows == 0)
+    {
+        *src_row_begin = 0;
+        *src_row_end = 0;
+        return;
+    }
+
+    std::shared_ptr<const TexMipUtilsTaps> taps_y = get_taps(src_height, dst_height, filter);
+
+    *src_row_begin = taps_y->first[dst_y];
+    *src_row_end = taps_y->first[dst_y + dst_rows - 1] + taps_y->num_taps;
+}
+
+void TexMipUtils_DownsampleRows(u32 src_width, u32 src_height, u32 src_y, const f32* in_data,
+                                u32 dst_width, u32 dst_height, u32 dst_y, u32 dst_rows, f32* out_data,
+                                TexMipUtilsFilter filter)
+{
+    assert(dst_width <= src_width && dst_height <= src_height);
+    assert(dst_rows <= dst_height && dst_y <= dst_height - dst_rows);
+
+    if (dst_width == 0 || dst_rows == 0)
+        return;
+
+    TexMipUtilsDownsampleJob job;
+    job.src_width = src_width;
+    job.src_y = src_y;
+    job.dst_width = dst_width;
+    job.dst_y = dst_y;
+    job.dst_rows = dst_rows;
+    job.in_data = in_data;
+    job.out_data = out_data;
+    job.filter_row = select_filter_row();
+    job.blend_rows = select_blend_rows();
+
+    const size_t row_size = (size_t)dst_width * 4 * sizeof(f32);
+    job.rows_per_band = (u32)((TEX_MIP_UTILS_MIN_BAND_SIZE + row_size - 1) / row_size);
+
+    job.taps_x = get_taps(src_width, dst_width, filter);
+    job.taps_y = get_taps(src_height, dst_height, filter);
+
+    TexThreadPool_ParallelFor((dst_rows + job.rows_per_band - 1) / job.rows_per_band, downsample_band, &job);
+}
+
+}
@@ -0,0 +1,215 @@
+#include <ninTexUtils/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Set while running tasks, so that nested parallel loops run serially
+// instead of waiting on the pool they are running on
+static thread_local bool tInParallelFor = false;
+
+class TexThreadPool
+{
+public:
+    ~TexThreadPool()
+    {
+        std::lock_guard<std::mutex> jobLock(mJobMutex);
+        stopWorkers();
+    }
+
+    void setNumThreads(u32 numThreads)
+    {
+        std::lock_guard<std::mutex> jobLock(mJobMutex);
+        stopWorkers();
+        mNumThreads = numThreads;
+    }
+
+    u32 getNumThreads()
+    {
+        std::lock_guard<std::mutex> jobLock(mJobMutex);
+        return resolveNumThreads();
+    }
+
+    void setScheduler(TexThreadPoolScheduler scheduler, void* schedulerData)
+    {
+        std::lock_guard<std::mutex> jobLock(mJobMutex);
+        mScheduler = scheduler;
+        mSchedulerData = schedulerData;
+    }
+
+    void parallelFor(u32 count, TexThreadPoolTask task, void* userData)
+    {
+        if (count == 0)
+            return;
+
+        if (tInParallelFor || count == 1)
+        {
+            runSerial(count, task, userData);
+            return;
+        }
+
+        std::unique_lock<std::mutex> jobLock(mJobMutex);
+
+        if (mScheduler)
+        {
+            TexThreadPoolScheduler scheduler = mScheduler;
+            void* schedulerData = mSchedulerData;
+            jobLock.unlock();
+
+            scheduler(schedulerData, count, task, userData);
+            return;
+        }
+
+        const u32 numWorkers = std::min(resolveNumThreads(), count) - 1;
+        if (numWorkers == 0)
+        {
+            jobLock.unlock();
+            runSerial(count, task, userData);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            while (mWorkers.size() < numWorkers)
+                mWorkers.emplace_back(&TexThreadPool::workerMain, this, mGeneration);
+
+            mTask = task;
+            mUserData = userData;
+            mCount = count;
+            mNext.store(0, std::memory_order_relaxed);
+            mNumFinished = 0;
+            mGeneration++;
+        }
+        mWorkCond.notify_all();
+
+        tInParallelFor = true;
+        runTasks(task, userData, count);
+        tInParallelFor = false;
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDoneCond.wait(lock, [this] { return mNumFinished == mWorkers.size(); });
+    }
+
+private:
+    u32 resolveNumThreads() const
+    {
+        if (mNumThreads != 0)
+            return mNumThreads;
+
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    static void runSerial(u32 count, TexThreadPoolTask task, void* userData)
+    {
+        const bool wasInParallelFor = tInParallelFor;
+        tInParallelFor = true;
+
+        for (u32 i = 0; i < count; i++)
+            task(userData, i);
+
+        tInParallelFor = wasInParallelFor;
+    }
+
+    void runTasks(TexThreadPoolTask task, void* userData, u32 count)
+    {
+        for (u32 i = mNext.fetch_add(1, std::memory_order_relaxed); i < count;
+                 i = mNext.fetch_add(1, std::memory_order_relaxed))
+            task(userData, i);
+    }
+
+    // Every worker takes part in every job (possibly finding no task left),
+    // so that the job's state stays valid until all of them are done with it
+    void workerMain(u64 generation)
+    {
+        tInParallelFor = true;
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        for (;;)
+        {
+            mWorkCond.wait(lock, [this, generation] { return mQuit || mGeneration != generation; });
+            if (mQuit)
+                return;
+
+            generation = mGeneration;
+            TexThreadPoolTask task = mTask;
+            void* userData = mUserData;
+            const u32 count = mCount;
+
+            lock.unlock();
+            runTasks(task, userData, count);
+            lock.lock();
+
+            if (++mNumFinished == mWorkers.size())
+                mDoneCond.notify_one();
+        }
+    }
+
+    // mJobMutex must be held
+    void stopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit = true;
+        }
+        mWorkCond.notify_all();
+
+        for (std::thread& worker : mWorkers)
+            worker.join();
+
+        mWorkers.clear();
+        mQuit = false;
+    }
+
+    std::mutex mJobMutex;   // One job at a time, guards the configuration
+    u32 mNumThreads = 0;
+    TexThreadPoolScheduler mScheduler = nullptr;
+    void* mSchedulerData = nullptr;
+
+    std::mutex mMutex;      // Guards the workers and the current job
+    std::condition_variable mWorkCond;
+    std::condition_variable mDoneCond;
+    std::vector<std::thread> mWorkers;
+    bool mQuit = false;
+    u64 mGeneration = 0;
+    u32 mNumFinished = 0;
+
+    TexThreadPoolTask mTask = nullptr;
+    void* mUserData = nullptr;
+    u32 mCount = 0;
+    std::atomic<u32> mNext{0};
+};
+
+static TexThreadPool& TexGetThreadPool()
+{
+    static TexThreadPool pool;
+    return pool;
+}
+
+extern "C"
+{
+
+void TexThreadPool_SetNumThreads(u32 numThreads)
+{
+    TexGetThreadPool().setNumThreads(numThreads);
+}
+
+u32 TexThreadPool_GetNumThreads(void)
+{
+    return TexGetThreadPool().getNumThreads();
+}
+
+void TexThreadPool_SetScheduler(TexThreadPoolScheduler scheduler, void* schedulerData)
+{
+    TexGetThreadPool().setScheduler(scheduler, schedulerData);
+}
+
+void TexThreadPool_ParallelFor(u32 count, TexThreadPoolTask task, void* userData)
+{
+    TexGetThreadPool().parallelFor(count, task, userData);
+}
+
+}